@@ -0,0 +1,64 @@
+#include "accuracy.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+AccuracyReport CompareRGBA(const uint8_t* test, const uint8_t* reference, int width, int height, int tolerance) {
+    AccuracyReport report;
+    report.tolerance = tolerance;
+
+    const long long pixels = static_cast<long long>(width) * height;
+    long long absSum[3] = {0, 0, 0};
+    double sqSum[3] = {0, 0, 0};
+
+    for (long long i = 0; i < pixels; i++) {
+        bool mismatch = false;
+        for (int c = 0; c < 3; c++) {
+            int diff = std::abs(static_cast<int>(test[i * 4 + c]) - static_cast<int>(reference[i * 4 + c]));
+            absSum[c] += diff;
+            sqSum[c] += static_cast<double>(diff) * diff;
+            if (diff > report.channels[c].maxAbsError) {
+                report.channels[c].maxAbsError = diff;
+            }
+            if (diff > tolerance) {
+                mismatch = true;
+            }
+        }
+        if (mismatch) {
+            report.mismatchedPixels++;
+        }
+    }
+
+    for (int c = 0; c < 3; c++) {
+        ChannelError& ch = report.channels[c];
+        ch.meanAbsError = pixels > 0 ? static_cast<double>(absSum[c]) / pixels : 0;
+        double mse = pixels > 0 ? sqSum[c] / pixels : 0;
+        ch.psnr = mse > 0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+    }
+
+    report.passed = report.mismatchedPixels == 0;
+    return report;
+}
+
+void PrintAccuracyReport(const char* label, const AccuracyReport& report) {
+    static const char* names[3] = { "R", "G", "B" };
+
+    std::cout << label << " accuracy (tolerance " << report.tolerance << "): "
+              << (report.passed ? "PASS" : "FAIL") << std::endl;
+    for (int c = 0; c < 3; c++) {
+        const ChannelError& ch = report.channels[c];
+        std::cout << "  " << names[c] << ": max abs " << ch.maxAbsError
+                  << ", mean abs " << ch.meanAbsError << ", PSNR ";
+        if (std::isinf(ch.psnr)) {
+            std::cout << "inf";
+        } else {
+            std::cout << ch.psnr;
+        }
+        std::cout << " dB" << std::endl;
+    }
+    if (!report.passed) {
+        std::cerr << "ACCURACY CHECK FAILED: " << label << " has " << report.mismatchedPixels
+                  << " pixels outside tolerance " << report.tolerance << std::endl;
+    }
+}
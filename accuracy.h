@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// Per-channel error of a test image against a reference
+struct ChannelError {
+    int maxAbsError = 0;
+    double meanAbsError = 0;
+    double psnr = 0;  // dB, infinity when identical
+};
+
+struct AccuracyReport {
+    ChannelError channels[3];  // R, G, B
+    long long mismatchedPixels = 0;  // pixels with any channel above tolerance
+    int tolerance = 0;
+    bool passed = false;
+};
+
+// Compare two RGBA8 images (alpha ignored). Passes when no channel of any
+// pixel differs by more than tolerance.
+AccuracyReport CompareRGBA(const uint8_t* test, const uint8_t* reference, int width, int height, int tolerance);
+
+void PrintAccuracyReport(const char* label, const AccuracyReport& report);
@@ -0,0 +1,55 @@
+#include "chroma_sampling.h"
+
+namespace {
+
+struct FetchDef {
+    const char* name;
+    ChromaFetch fetch;
+    bool nearest;
+};
+
+const FetchDef kFetches[] = {
+    { "linear",     ChromaFetch::Sampler,    false },
+    { "nearest",    ChromaFetch::Sampler,    true  },
+    { "texelfetch", ChromaFetch::TexelFetch, false },
+    { "gather",     ChromaFetch::Gather,     false },
+};
+
+} // namespace
+
+std::vector<ChromaSampling> BuildChromaSamplingMatrix() {
+    std::vector<ChromaSampling> strategies;
+    for (const FetchDef& fetch : kFetches) {
+        for (int immutable = 0; immutable <= 1; immutable++) {
+            ChromaSampling sampling;
+            sampling.name = std::string(fetch.name) + (immutable ? "_immutable" : "");
+            sampling.fetch = fetch.fetch;
+            sampling.nearest = fetch.nearest;
+            sampling.immutable = immutable != 0;
+            strategies.push_back(sampling);
+        }
+    }
+    return strategies;
+}
+
+bool FindChromaSampling(const std::string& name, ChromaSampling& sampling) {
+    for (const ChromaSampling& candidate : BuildChromaSamplingMatrix()) {
+        if (candidate.name == name) {
+            sampling = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> ChromaSamplingDefines(const ChromaSampling& sampling) {
+    switch (sampling.fetch) {
+        case ChromaFetch::TexelFetch: return { "CHROMA_TEXEL_FETCH" };
+        case ChromaFetch::Gather: return { "CHROMA_GATHER" };
+        default: return {};
+    }
+}
+
+bool ChromaSamplingNeedsEs31(const ChromaSampling& sampling) {
+    return sampling.fetch == ChromaFetch::Gather;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// How the conversion shader reads chroma
+enum class ChromaFetch {
+    Sampler,     // texture() through the sampler: the hardware filters (default)
+    TexelFetch,  // integer texelFetch of luma and the four chroma texels, bilinear weights in ALU
+    Gather,      // textureGather of the 2x2 chroma footprint per channel (GLSL ES 3.10)
+};
+
+// One chroma sampling strategy of the --sampling benchmark
+struct ChromaSampling {
+    std::string name;        // e.g. "gather_immutable"
+    ChromaFetch fetch;
+    bool nearest;            // GL_NEAREST chroma: replicate instead of bilinear upsampling
+    bool immutable;          // glTexStorage2D instead of mutable glTexImage2D textures
+};
+
+// linear, nearest, texelfetch and gather, each with mutable and immutable
+// textures. The first entry is the main-run configuration.
+std::vector<ChromaSampling> BuildChromaSamplingMatrix();
+bool FindChromaSampling(const std::string& name, ChromaSampling& sampling);
+
+// Shader #defines selecting the fetch code in fragmentShaderSource
+std::vector<std::string> ChromaSamplingDefines(const ChromaSampling& sampling);
+
+// textureGather needs the program compiled as GLSL ES 3.10
+bool ChromaSamplingNeedsEs31(const ChromaSampling& sampling);
@@ -0,0 +1,194 @@
+#include "compile_bench.h"
+#include "gl_common.h"
+#include "shader_variants.h"
+#include <EGL/egl.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (GL_APIENTRYP PFN_glMaxShaderCompilerThreadsKHR)(GLuint count);
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct ProgramSources {
+    std::string vs;
+    std::string fs;
+};
+
+// Unique sources per program; the nonce keeps repeated runs cold in driver caches
+std::vector<ProgramSources> makeSources(const char* vsSource, const char* fsSource,
+                                        const std::vector<std::vector<std::string>>& fsDefines, int count) {
+    std::mt19937_64 rng(std::random_device{}());
+    unsigned long long nonce = rng() & 0xFFFFFFFFFFFFull;
+
+    std::vector<ProgramSources> sources(count);
+    for (int i = 0; i < count; i++) {
+        std::vector<std::string> defines = fsDefines.empty() ? std::vector<std::string>() : fsDefines[i % fsDefines.size()];
+        std::string id = "COMPILE_BENCH_ID_" + std::to_string(nonce) + "_" + std::to_string(i);
+        defines.push_back(id);
+        sources[i].vs = InjectShaderDefines(vsSource, { id });
+        sources[i].fs = InjectShaderDefines(fsSource, defines);
+    }
+    return sources;
+}
+
+GLuint createShader(GLenum type, const std::string& source) {
+    GLuint shader = glCreateShader(type);
+    const char* text = source.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+bool linkStatus(GLuint program) {
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked == GL_TRUE;
+}
+
+} // namespace
+
+CompileBenchResult RunCompileBenchmark(const char* vsSource, const char* fsSource,
+                                       const std::vector<std::vector<std::string>>& fsDefines, int count) {
+    CompileBenchResult result;
+    result.programCount = count;
+
+    PFN_glMaxShaderCompilerThreadsKHR pglMaxShaderCompilerThreadsKHR = nullptr;
+    result.parallelExtension = hasGLExtension("GL_KHR_parallel_shader_compile");
+    if (result.parallelExtension) {
+        pglMaxShaderCompilerThreadsKHR =
+            (PFN_glMaxShaderCompilerThreadsKHR)eglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    }
+
+    // Serial pass: query each status right away, which blocks until that stage is done
+    {
+        if (pglMaxShaderCompilerThreadsKHR) {
+            pglMaxShaderCompilerThreadsKHR(0);
+        }
+        std::vector<ProgramSources> sources = makeSources(vsSource, fsSource, fsDefines, count);
+        std::vector<double> vsTimes, fsTimes, linkTimes;
+        GLint status;
+
+        auto wallStart = Clock::now();
+        for (const ProgramSources& src : sources) {
+            auto start = Clock::now();
+            GLuint vs = createShader(GL_VERTEX_SHADER, src.vs);
+            glGetShaderiv(vs, GL_COMPILE_STATUS, &status);
+            vsTimes.push_back(elapsedMs(start));
+
+            start = Clock::now();
+            GLuint fs = createShader(GL_FRAGMENT_SHADER, src.fs);
+            glGetShaderiv(fs, GL_COMPILE_STATUS, &status);
+            fsTimes.push_back(elapsedMs(start));
+
+            start = Clock::now();
+            GLuint program = glCreateProgram();
+            glAttachShader(program, vs);
+            glAttachShader(program, fs);
+            glLinkProgram(program);
+            bool linked = linkStatus(program);
+            linkTimes.push_back(elapsedMs(start));
+
+            result.allLinked = result.allLinked && linked;
+            glDeleteShader(vs);
+            glDeleteShader(fs);
+            glDeleteProgram(program);
+        }
+        result.serialWallMs = elapsedMs(wallStart);
+
+        result.vertexCompile = computeStats(vsTimes);
+        result.fragmentCompile = computeStats(fsTimes);
+        result.link = computeStats(linkTimes);
+    }
+
+    // Parallel pass: submit everything, then poll GL_COMPLETION_STATUS_KHR.
+    // Without the extension the same batch is submitted and the link status
+    // query blocks per program, leaving any overlap to the driver.
+    {
+        if (pglMaxShaderCompilerThreadsKHR) {
+            pglMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);  // let the driver pick
+        }
+        std::vector<ProgramSources> sources = makeSources(vsSource, fsSource, fsDefines, count);
+        std::vector<GLuint> programs(count);
+
+        auto wallStart = Clock::now();
+        for (int i = 0; i < count; i++) {
+            GLuint vs = createShader(GL_VERTEX_SHADER, sources[i].vs);
+            GLuint fs = createShader(GL_FRAGMENT_SHADER, sources[i].fs);
+            programs[i] = glCreateProgram();
+            glAttachShader(programs[i], vs);
+            glAttachShader(programs[i], fs);
+            glLinkProgram(programs[i]);
+            // Flagged for deletion; freed once the program is deleted
+            glDeleteShader(vs);
+            glDeleteShader(fs);
+        }
+        result.parallelSubmitMs = elapsedMs(wallStart);
+
+        if (result.parallelExtension) {
+            std::vector<bool> done(count, false);
+            int remaining = count;
+            while (remaining > 0) {
+                result.pollIterations++;
+                for (int i = 0; i < count; i++) {
+                    if (done[i]) continue;
+                    GLint complete = GL_FALSE;
+                    glGetProgramiv(programs[i], GL_COMPLETION_STATUS_KHR, &complete);
+                    if (complete) {
+                        done[i] = true;
+                        remaining--;
+                    }
+                }
+                if (remaining > 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        for (GLuint program : programs) {
+            result.allLinked = result.allLinked && linkStatus(program);
+        }
+        result.parallelWallMs = elapsedMs(wallStart);
+
+        for (GLuint program : programs) {
+            glDeleteProgram(program);
+        }
+    }
+
+    return result;
+}
+
+void PrintCompileBenchResult(const CompileBenchResult& result) {
+    std::cout << "\nShader Compile Benchmark (" << result.programCount << " programs):" << std::endl;
+    printStats("Vertex compile", result.vertexCompile);
+    printStats("Fragment compile", result.fragmentCompile);
+    printStats("Link", result.link);
+    std::cout << "Serial wall time:   " << result.serialWallMs << " ms" << std::endl;
+    std::cout << "Parallel wall time: " << result.parallelWallMs << " ms (submit " << result.parallelSubmitMs << " ms, ";
+    if (result.parallelExtension) {
+        std::cout << "GL_KHR_parallel_shader_compile, " << result.pollIterations << " poll rounds)" << std::endl;
+    } else {
+        std::cout << "GL_KHR_parallel_shader_compile not supported, batch submit only)" << std::endl;
+    }
+    if (result.parallelWallMs > 0) {
+        std::cout << "Speedup: " << result.serialWallMs / result.parallelWallMs << "x" << std::endl;
+    }
+    if (!result.allLinked) {
+        std::cerr << "Shader compile benchmark: some programs failed to link" << std::endl;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "perf_stats.h"
+#include <string>
+#include <vector>
+
+// Shader compile/link benchmark results
+struct CompileBenchResult {
+    int programCount = 0;
+    bool allLinked = true;
+
+    // Serial: each stage completed (status queried) before the next starts
+    PerfStats vertexCompile;
+    PerfStats fragmentCompile;
+    PerfStats link;
+    double serialWallMs = 0;
+
+    // Parallel: everything submitted up front, then completion polled
+    bool parallelExtension = false;  // GL_KHR_parallel_shader_compile available
+    double parallelWallMs = 0;
+    double parallelSubmitMs = 0;     // time to issue all compiles and links
+    int pollIterations = 0;
+};
+
+// Compile and link count programs built from vsSource and fsSource, each made
+// unique with a define so driver-side caches cannot short-circuit the work.
+// fsDefines lists the variant define sets to cycle through.
+CompileBenchResult RunCompileBenchmark(const char* vsSource, const char* fsSource,
+                                       const std::vector<std::vector<std::string>>& fsDefines, int count);
+
+void PrintCompileBenchResult(const CompileBenchResult& result);
@@ -0,0 +1,162 @@
+#include "compute_converter.h"
+#include "shader_variants.h"
+#include <EGL/egl.h>
+#include <iostream>
+
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+#ifndef GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS
+#define GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS 0x90EB
+#endif
+
+#ifndef GL_MAX_COMPUTE_WORK_GROUP_SIZE
+#define GL_MAX_COMPUTE_WORK_GROUP_SIZE 0x91BF
+#endif
+
+#ifndef GL_WRITE_ONLY
+#define GL_WRITE_ONLY 0x88B9
+#endif
+
+#ifndef GL_TEXTURE_FETCH_BARRIER_BIT
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#endif
+
+#ifndef GL_FRAMEBUFFER_BARRIER_BIT
+#define GL_FRAMEBUFFER_BARRIER_BIT 0x00000400
+#endif
+
+#ifndef GL_PIXEL_BUFFER_BARRIER_BIT
+#define GL_PIXEL_BUFFER_BARRIER_BIT 0x00000080
+#endif
+
+typedef void (GL_APIENTRYP PFN_glDispatchCompute)(GLuint numGroupsX, GLuint numGroupsY, GLuint numGroupsZ);
+typedef void (GL_APIENTRYP PFN_glBindImageTexture)(GLuint unit, GLuint texture, GLint level, GLboolean layered,
+                                                    GLint layer, GLenum access, GLenum format);
+typedef void (GL_APIENTRYP PFN_glMemoryBarrier)(GLbitfield barriers);
+
+namespace {
+
+PFN_glDispatchCompute dispatchCompute = nullptr;
+PFN_glBindImageTexture bindImageTexture = nullptr;
+PFN_glMemoryBarrier memoryBarrier = nullptr;
+
+} // namespace
+
+bool InitComputeFunctions() {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major < 3 || (major == 3 && minor < 1)) {
+        std::cout << "Compute shaders need OpenGL ES 3.1, context is " << major << "." << minor << std::endl;
+        return false;
+    }
+
+    dispatchCompute = (PFN_glDispatchCompute)eglGetProcAddress("glDispatchCompute");
+    bindImageTexture = (PFN_glBindImageTexture)eglGetProcAddress("glBindImageTexture");
+    memoryBarrier = (PFN_glMemoryBarrier)eglGetProcAddress("glMemoryBarrier");
+    if (!dispatchCompute || !bindImageTexture || !memoryBarrier) {
+        std::cout << "OpenGL ES 3.1 compute entry points not found" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<ComputeConfig> BuildComputeSweep(const std::vector<std::pair<int, int>>& workgroupSizes,
+                                             const std::vector<std::pair<int, int>>& pixelBlocks) {
+    GLint maxInvocations = 0, maxSizeX = 0, maxSizeY = 0;
+    glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &maxInvocations);
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 0, &maxSizeX);
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 1, &maxSizeY);
+
+    std::vector<ComputeConfig> configs;
+    for (const auto& workgroup : workgroupSizes) {
+        if (workgroup.first * workgroup.second > maxInvocations || workgroup.first > maxSizeX ||
+            workgroup.second > maxSizeY) {
+            std::cout << "Skipping workgroup " << workgroup.first << "x" << workgroup.second
+                      << ": exceeds compute limits (" << maxInvocations << " invocations, "
+                      << maxSizeX << "x" << maxSizeY << ")" << std::endl;
+            continue;
+        }
+        for (const auto& block : pixelBlocks) {
+            ComputeConfig config;
+            config.localSizeX = workgroup.first;
+            config.localSizeY = workgroup.second;
+            config.pixelsX = block.first;
+            config.pixelsY = block.second;
+            config.name = "wg" + std::to_string(workgroup.first) + "x" + std::to_string(workgroup.second) +
+                          "_px" + std::to_string(block.first) + "x" + std::to_string(block.second);
+            configs.push_back(config);
+        }
+    }
+    return configs;
+}
+
+GLuint BuildComputeProgram(const char* source, const ComputeConfig& config, const std::vector<std::string>& defines) {
+    std::vector<std::string> allDefines = defines;
+    allDefines.push_back("LOCAL_SIZE_X " + std::to_string(config.localSizeX));
+    allDefines.push_back("LOCAL_SIZE_Y " + std::to_string(config.localSizeY));
+    allDefines.push_back("PIXELS_X " + std::to_string(config.pixelsX));
+    allDefines.push_back("PIXELS_Y " + std::to_string(config.pixelsY));
+    std::string text = InjectShaderDefines(source, allDefines);
+    const char* textPtr = text.c_str();
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, &textPtr, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Compute shader compilation failed (" << config.name << "): " << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glDeleteShader(shader);
+
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Compute program linking failed (" << config.name << "): " << infoLog << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "yTexture"), 0);
+    glUniform1i(glGetUniformLocation(program, "uvTexture"), 1);
+    return program;
+}
+
+GLuint CreateComputeOutputTexture(int width, int height) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return texture;
+}
+
+void DispatchComputeConversion(GLuint program, const ComputeConfig& config, GLuint yTexture, GLuint uvTexture,
+                               GLuint outputTexture, int width, int height) {
+    glUseProgram(program);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, yTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, uvTexture);
+    bindImageTexture(0, outputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+    const int blockX = config.localSizeX * config.pixelsX;
+    const int blockY = config.localSizeY * config.pixelsY;
+    dispatchCompute((width + blockX - 1) / blockX, (height + blockY - 1) / blockY, 1);
+    memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+}
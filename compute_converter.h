@@ -0,0 +1,37 @@
+#pragma once
+
+#include "gl_common.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Workgroup shape and per-invocation work of one compute-shader configuration
+struct ComputeConfig {
+    int localSizeX = 16;
+    int localSizeY = 16;
+    int pixelsX = 1;  // output pixels per invocation
+    int pixelsY = 1;
+    std::string name;  // e.g. "wg16x8_px2x2"
+};
+
+// Load the OpenGL ES 3.1 compute entry points through eglGetProcAddress, so the
+// build only needs the ES 3.0 headers. Returns false if the context is older
+// than ES 3.1 or an entry point is missing.
+bool InitComputeFunctions();
+
+// Every workgroup size x pixels-per-invocation combination that fits the
+// context's compute limits
+std::vector<ComputeConfig> BuildComputeSweep(const std::vector<std::pair<int, int>>& workgroupSizes,
+                                             const std::vector<std::pair<int, int>>& pixelBlocks);
+
+// Compile computeShaderSource specialized for config plus extra defines (e.g. a
+// shader variant). Returns 0 on failure.
+GLuint BuildComputeProgram(const char* source, const ComputeConfig& config, const std::vector<std::string>& defines);
+
+// Immutable RGBA8 texture usable with imageStore
+GLuint CreateComputeOutputTexture(int width, int height);
+
+// Convert one frame: dispatch enough workgroups to cover width x height and
+// make the image writes visible to later texture fetches and framebuffer reads
+void DispatchComputeConversion(GLuint program, const ComputeConfig& config, GLuint yTexture, GLuint uvTexture,
+                               GLuint outputTexture, int width, int height);
@@ -0,0 +1,227 @@
+#include "conversion_worker.h"
+#include "texture_utils.h"
+#include <iostream>
+
+#ifndef EGL_CONTEXT_MAJOR_VERSION
+#define EGL_CONTEXT_MAJOR_VERSION 0x3098
+#endif
+
+#ifndef EGL_CONTEXT_MINOR_VERSION
+#define EGL_CONTEXT_MINOR_VERSION 0x30FB
+#endif
+
+#ifndef EGL_NO_CONFIG_KHR
+#define EGL_NO_CONFIG_KHR ((EGLConfig)0)
+#endif
+
+EGLContext CreateES3Context(EGLDisplay display, EGLConfig config, EGLContext shareContext) {
+    // Ask for ES 3.1 (compute shaders) first, then fall back to any ES 3.x
+    const EGLint context31Attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 1,
+        EGL_NONE
+    };
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_CLIENT_VERSION, 3,
+        EGL_NONE
+    };
+
+    EGLContext context = eglCreateContext(display, config, shareContext, context31Attribs);
+    if (context == EGL_NO_CONTEXT) {
+        context = eglCreateContext(display, config, shareContext, contextAttribs);
+    }
+    return context;
+}
+
+bool CreateWorkerContext(ConversionWorker& worker, EGLDisplay display, EGLConfig config, EGLContext shareContext) {
+    worker.display = display;
+    worker.context = CreateES3Context(display, config, shareContext);
+    if (worker.context == EGL_NO_CONTEXT) {
+        std::cerr << "Failed to create worker EGL context: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        return false;
+    }
+
+    worker.surface = EGL_NO_SURFACE;
+    if (!hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        const EGLint pbufferAttribs[] = {
+            EGL_WIDTH, 1,
+            EGL_HEIGHT, 1,
+            EGL_NONE
+        };
+        if (config != EGL_NO_CONFIG_KHR) {
+            worker.surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        }
+        if (worker.surface == EGL_NO_SURFACE) {
+            std::cerr << "Failed to create worker pbuffer surface" << std::endl;
+            eglDestroyContext(display, worker.context);
+            worker.context = EGL_NO_CONTEXT;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MakeWorkerCurrent(const ConversionWorker& worker) {
+    if (!eglMakeCurrent(worker.display, worker.surface, worker.surface, worker.context)) {
+        std::cerr << "Failed to make worker context current: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DestroyWorkerContext(ConversionWorker& worker) {
+    eglMakeCurrent(worker.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (worker.context != EGL_NO_CONTEXT) {
+        eglDestroyContext(worker.display, worker.context);
+    }
+    if (worker.surface != EGL_NO_SURFACE) {
+        eglDestroySurface(worker.display, worker.surface);
+    }
+    worker.context = EGL_NO_CONTEXT;
+    worker.surface = EGL_NO_SURFACE;
+}
+
+void InitWorkerGeometry(ConversionWorker& worker) {
+    float vertices[] = {
+        // Position          // Texture coordinates
+        -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+         1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+         1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
+        -1.0f,  1.0f, 0.0f, 0.0f, 1.0f
+    };
+
+    unsigned int indices[] = {
+        0, 1, 2,
+        0, 2, 3
+    };
+
+    glGenVertexArrays(1, &worker.vao);
+    glGenBuffers(1, &worker.vbo);
+    glGenBuffers(1, &worker.ebo);
+
+    glBindVertexArray(worker.vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, worker.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, worker.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+}
+
+void ReleaseWorkerGeometry(ConversionWorker& worker) {
+    glDeleteVertexArrays(1, &worker.vao);
+    glDeleteBuffers(1, &worker.vbo);
+    glDeleteBuffers(1, &worker.ebo);
+    worker.vao = worker.vbo = worker.ebo = 0;
+}
+
+void SetNV12SamplerState(GLenum filter) {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void CreateNV12Textures(int width, int height, const uint8_t* nv12, bool immutable, GLenum chromaFilter,
+                        GLuint& yTex, GLuint& uvTex) {
+    const int chromaWidth = NV12ChromaWidth(width);
+    const int chromaHeight = NV12ChromaHeight(height);
+    const uint8_t* uvPlane = nv12 ? nv12 + static_cast<size_t>(width) * height : nullptr;
+
+    // Rows of odd-width frames are not 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glGenTextures(1, &yTex);
+    glBindTexture(GL_TEXTURE_2D, yTex);
+    if (immutable) {
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, height);
+        if (nv12) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, nv12);
+        }
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, nv12);
+    }
+    SetNV12SamplerState();
+
+    glGenTextures(1, &uvTex);
+    glBindTexture(GL_TEXTURE_2D, uvTex);
+    if (immutable) {
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG8, chromaWidth, chromaHeight);
+        if (uvPlane) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, chromaWidth, chromaHeight, GL_RG, GL_UNSIGNED_BYTE, uvPlane);
+        }
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, chromaWidth, chromaHeight, 0, GL_RG, GL_UNSIGNED_BYTE, uvPlane);
+    }
+    SetNV12SamplerState(chromaFilter);
+}
+
+bool InitWorkerFrame(ConversionWorker& worker, const uint8_t* nv12, int width, int height) {
+    worker.width = width;
+    worker.height = height;
+    CreateNV12Textures(width, height, nv12, false, GL_LINEAR, worker.yTexture, worker.uvTexture);
+
+    glGenFramebuffers(1, &worker.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, worker.fbo);
+
+    glGenTextures(1, &worker.outputTexture);
+    glBindTexture(GL_TEXTURE_2D, worker.outputTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, worker.outputTexture, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Framebuffer is not complete! Status: " << status << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void UploadWorkerFrame(const ConversionWorker& worker, const uint8_t* nv12) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, worker.yTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, worker.width, worker.height, GL_RED, GL_UNSIGNED_BYTE, nv12);
+    glBindTexture(GL_TEXTURE_2D, worker.uvTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, NV12ChromaWidth(worker.width), NV12ChromaHeight(worker.height),
+                    GL_RG, GL_UNSIGNED_BYTE, nv12 + static_cast<size_t>(worker.width) * worker.height);
+}
+
+void ReleaseWorkerFrame(ConversionWorker& worker) {
+    glDeleteFramebuffers(1, &worker.fbo);
+    glDeleteTextures(1, &worker.outputTexture);
+    glDeleteTextures(1, &worker.yTexture);
+    glDeleteTextures(1, &worker.uvTexture);
+    worker.fbo = worker.outputTexture = worker.yTexture = worker.uvTexture = 0;
+}
+
+void SetConversionSamplerUnits(GLuint program) {
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "yTexture"), 0);
+    glUniform1i(glGetUniformLocation(program, "uvTexture"), 1);
+    glUniform1i(glGetUniformLocation(program, "uTexture"), 1);  // I420 input only
+    glUniform1i(glGetUniformLocation(program, "vTexture"), 2);
+}
+
+void BeginWorkerPass(const ConversionWorker& worker) {
+    glUseProgram(worker.program);
+    glBindFramebuffer(GL_FRAMEBUFFER, worker.fbo);
+    glViewport(0, 0, worker.width, worker.height);
+}
+
+void DrawWorkerFrame(const ConversionWorker& worker, GLuint yTex, GLuint uvTex) {
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, yTex);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, uvTex);
+
+    glBindVertexArray(worker.vao);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+}
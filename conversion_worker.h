@@ -0,0 +1,65 @@
+#pragma once
+
+#include "gl_common.h"
+#include <EGL/egl.h>
+#include <cstdint>
+
+// GL state one thread needs to convert NV12 frames: its EGL context, the
+// conversion program, the quad, the NV12 input textures and the RGBA8 output
+// framebuffer. The context is current on at most one thread at a time. Only the
+// program can be shared with other workers (through a shared context); vertex
+// arrays and framebuffers are container objects and always belong to one context.
+struct ConversionWorker {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;  // 1x1 pbuffer, or none when surfaceless
+
+    GLuint program = 0;
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    GLuint yTexture = 0, uvTexture = 0;
+    GLuint fbo = 0, outputTexture = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Create an ES 3.1 context, falling back to ES 3.x. shareContext may be
+// EGL_NO_CONTEXT. Returns EGL_NO_CONTEXT on failure.
+EGLContext CreateES3Context(EGLDisplay display, EGLConfig config, EGLContext shareContext);
+
+// Create the worker's context (and a 1x1 pbuffer when EGL_KHR_surfaceless_context
+// is missing). The context is not made current.
+bool CreateWorkerContext(ConversionWorker& worker, EGLDisplay display, EGLConfig config, EGLContext shareContext);
+bool MakeWorkerCurrent(const ConversionWorker& worker);
+
+// Release the context from the calling thread and destroy it and its surface
+void DestroyWorkerContext(ConversionWorker& worker);
+
+// Full-screen quad used by every conversion draw
+void InitWorkerGeometry(ConversionWorker& worker);
+void ReleaseWorkerGeometry(ConversionWorker& worker);
+
+// Filtering and wrap state for the bound Y or UV texture. CLAMP_TO_EDGE keeps
+// bilinear chroma at the frame borders from wrapping to the opposite edge.
+void SetNV12SamplerState(GLenum filter = GL_LINEAR);
+
+// Create a Y/UV texture pair from a host frame (nullptr = uninitialized).
+// immutable allocates with glTexStorage2D instead of glTexImage2D; chromaFilter
+// is the UV texture's min/mag filter (luma always uses GL_LINEAR).
+void CreateNV12Textures(int width, int height, const uint8_t* nv12, bool immutable, GLenum chromaFilter,
+                        GLuint& yTex, GLuint& uvTex);
+
+// Create the NV12 textures from a host frame (nullptr = uninitialized) and the
+// RGBA8 output framebuffer. Returns false if the framebuffer is incomplete.
+bool InitWorkerFrame(ConversionWorker& worker, const uint8_t* nv12, int width, int height);
+void UploadWorkerFrame(const ConversionWorker& worker, const uint8_t* nv12);
+void ReleaseWorkerFrame(ConversionWorker& worker);
+
+// Point the conversion program's samplers at units 0 (Y), 1 (UV or U) and 2 (V).
+// Uniforms are program state, so a shared program only needs this once.
+void SetConversionSamplerUnits(GLuint program);
+
+// Bind the program and output framebuffer for the conversion draws
+void BeginWorkerPass(const ConversionWorker& worker);
+
+// Issue the draw for one converted frame
+void DrawWorkerFrame(const ConversionWorker& worker, GLuint yTex, GLuint uvTex);
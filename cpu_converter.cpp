@@ -0,0 +1,265 @@
+#include "cpu_converter.h"
+#include "thread_pool.h"
+#include "texture_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_CONVERTER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace {
+
+// Bilinear tap for one output coordinate along one axis
+struct LinearTap {
+    int i0;
+    int i1;
+    float w1;  // weight of i1; i0 gets 1 - w1
+};
+
+// GL_LINEAR taps for mapping dstSize texel centers onto a srcSize texture.
+// GL_NEAREST is the degenerate tap: the texel containing the center, weight 0.
+std::vector<LinearTap> buildTaps(int dstSize, int srcSize, ChromaFilter filter) {
+    std::vector<LinearTap> taps(dstSize);
+    for (int d = 0; d < dstSize; d++) {
+        if (filter == ChromaFilter::Nearest) {
+            int i = std::clamp(static_cast<int>(std::floor((d + 0.5f) * srcSize / dstSize)), 0, srcSize - 1);
+            taps[d] = { i, i, 0.0f };
+            continue;
+        }
+        float coord = (d + 0.5f) * srcSize / dstSize - 0.5f;
+        int i0 = static_cast<int>(std::floor(coord));
+        float frac = coord - i0;
+        taps[d].i0 = std::clamp(i0, 0, srcSize - 1);
+        taps[d].i1 = std::clamp(i0 + 1, 0, srcSize - 1);
+        taps[d].w1 = frac;
+    }
+    return taps;
+}
+
+inline uint8_t toUnorm8(float v) {
+    v = std::min(std::max(v, 0.0f), 1.0f);
+    return static_cast<uint8_t>(std::lrint(v * 255.0f));
+}
+
+// u/v are already normalized and centered ((C - uvOffset) * uvScale)
+void convertRowScalar(const uint8_t* yRow, const float* u, const float* v, uint8_t* out,
+                      int begin, int width, const YuvToRgbCoefficients& c) {
+    for (int x = begin; x < width; x++) {
+        float y = (yRow[x] * (1.0f / 255.0f) - c.yOffset) * c.yScale;
+        out[x * 4 + 0] = toUnorm8(y + c.rv * v[x]);
+        out[x * 4 + 1] = toUnorm8(y - c.gu * u[x] - c.gv * v[x]);
+        out[x * 4 + 2] = toUnorm8(y + c.bu * u[x]);
+        out[x * 4 + 3] = 255;
+    }
+}
+
+#ifdef CPU_CONVERTER_X86
+void convertRowSSE2(const uint8_t* yRow, const float* u, const float* v, uint8_t* out,
+                    int width, const YuvToRgbCoefficients& c) {
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+    const __m128 yOffset = _mm_set1_ps(c.yOffset), yScale = _mm_set1_ps(c.yScale);
+    const __m128 rv = _mm_set1_ps(c.rv), gu = _mm_set1_ps(c.gu);
+    const __m128 gv = _mm_set1_ps(c.gv), bu = _mm_set1_ps(c.bu);
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), max8 = _mm_set1_ps(255.0f);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i zeroi = _mm_setzero_si128();
+
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        int packedY;
+        memcpy(&packedY, yRow + x, 4);
+        __m128i y8 = _mm_cvtsi32_si128(packedY);
+        __m128i y32 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(y8, zeroi), zeroi);
+        __m128 y = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(y32), scale), yOffset), yScale);
+        __m128 uu = _mm_loadu_ps(u + x);
+        __m128 vv = _mm_loadu_ps(v + x);
+
+        __m128 r = _mm_add_ps(y, _mm_mul_ps(rv, vv));
+        __m128 g = _mm_sub_ps(_mm_sub_ps(y, _mm_mul_ps(gu, uu)), _mm_mul_ps(gv, vv));
+        __m128 b = _mm_add_ps(y, _mm_mul_ps(bu, uu));
+
+        __m128i ri = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(r, zero), one), max8));
+        __m128i gi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(g, zero), one), max8));
+        __m128i bi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(b, zero), one), max8));
+
+        __m128i rgba = _mm_or_si128(_mm_or_si128(ri, _mm_slli_epi32(gi, 8)),
+                                    _mm_or_si128(_mm_slli_epi32(bi, 16), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), rgba);
+    }
+    convertRowScalar(yRow, u, v, out, x, width, c);
+}
+
+TARGET_AVX2
+void convertRowAVX2(const uint8_t* yRow, const float* u, const float* v, uint8_t* out,
+                    int width, const YuvToRgbCoefficients& c) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+    const __m256 yOffset = _mm256_set1_ps(c.yOffset), yScale = _mm256_set1_ps(c.yScale);
+    const __m256 rv = _mm256_set1_ps(c.rv), gu = _mm256_set1_ps(c.gu);
+    const __m256 gv = _mm256_set1_ps(c.gv), bu = _mm256_set1_ps(c.bu);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), max8 = _mm256_set1_ps(255.0f);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i y8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(yRow + x));
+        __m256 y = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(y8)), scale);
+        y = _mm256_mul_ps(_mm256_sub_ps(y, yOffset), yScale);
+        __m256 uu = _mm256_loadu_ps(u + x);
+        __m256 vv = _mm256_loadu_ps(v + x);
+
+        __m256 r = _mm256_add_ps(y, _mm256_mul_ps(rv, vv));
+        __m256 g = _mm256_sub_ps(_mm256_sub_ps(y, _mm256_mul_ps(gu, uu)), _mm256_mul_ps(gv, vv));
+        __m256 b = _mm256_add_ps(y, _mm256_mul_ps(bu, uu));
+
+        __m256i ri = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(r, zero), one), max8));
+        __m256i gi = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(g, zero), one), max8));
+        __m256i bi = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(b, zero), one), max8));
+
+        __m256i rgba = _mm256_or_si256(_mm256_or_si256(ri, _mm256_slli_epi32(gi, 8)),
+                                       _mm256_or_si256(_mm256_slli_epi32(bi, 16), alpha));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), rgba);
+    }
+    convertRowScalar(yRow, u, v, out, x, width, c);
+}
+#endif
+
+// 16-bit luma (P010), normalized by the caller's scale; scalar only
+void convertRowScalar16(const uint16_t* yRow, float yNorm, const float* u, const float* v, uint8_t* out,
+                        int width, const YuvToRgbCoefficients& c) {
+    for (int x = 0; x < width; x++) {
+        float y = (yRow[x] * yNorm - c.yOffset) * c.yScale;
+        out[x * 4 + 0] = toUnorm8(y + c.rv * v[x]);
+        out[x * 4 + 1] = toUnorm8(y - c.gu * u[x] - c.gv * v[x]);
+        out[x * 4 + 2] = toUnorm8(y + c.bu * u[x]);
+        out[x * 4 + 3] = 255;
+    }
+}
+
+// Shared frame loop: chroma of Sample type (uint8_t or uint16_t words) is
+// upsampled and normalized by sampleNorm, then convertRow(y, u, v, out) writes
+// one output row
+template <typename Sample, typename RowFn>
+void convertFrame(const Sample* uv_plane, uint8_t* rgba, int width, int height, const YuvToRgbCoefficients& coeffs,
+                  float sampleNorm, ThreadPool* pool, ChromaFilter filter, RowFn convertRow) {
+    const int chromaWidth = NV12ChromaWidth(width);
+    const int chromaHeight = NV12ChromaHeight(height);
+    const std::vector<LinearTap> colTaps = buildTaps(width, chromaWidth, filter);
+    const std::vector<LinearTap> rowTaps = buildTaps(height, chromaHeight, filter);
+
+    auto convertBand = [&](int rowBegin, int rowEnd) {
+        // Vertically blended chroma row, then horizontally upsampled per pixel
+        std::vector<float> uBlend(chromaWidth), vBlend(chromaWidth);
+        std::vector<float> u(width), v(width);
+
+        for (int y = rowBegin; y < rowEnd; y++) {
+            const LinearTap& ty = rowTaps[y];
+            const Sample* c0 = uv_plane + static_cast<size_t>(ty.i0) * chromaWidth * 2;
+            const Sample* c1 = uv_plane + static_cast<size_t>(ty.i1) * chromaWidth * 2;
+            for (int k = 0; k < chromaWidth; k++) {
+                uBlend[k] = c0[k * 2] + (static_cast<float>(c1[k * 2]) - c0[k * 2]) * ty.w1;
+                vBlend[k] = c0[k * 2 + 1] + (static_cast<float>(c1[k * 2 + 1]) - c0[k * 2 + 1]) * ty.w1;
+            }
+            for (int x = 0; x < width; x++) {
+                const LinearTap& tx = colTaps[x];
+                float uSample = (uBlend[tx.i0] + (uBlend[tx.i1] - uBlend[tx.i0]) * tx.w1) * sampleNorm;
+                float vSample = (vBlend[tx.i0] + (vBlend[tx.i1] - vBlend[tx.i0]) * tx.w1) * sampleNorm;
+                u[x] = (uSample - coeffs.uvOffset) * coeffs.uvScale;
+                v[x] = (vSample - coeffs.uvOffset) * coeffs.uvScale;
+            }
+
+            convertRow(y, u.data(), v.data(), rgba + static_cast<size_t>(y) * width * 4);
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(height, convertBand);
+    } else {
+        convertBand(0, height);
+    }
+}
+
+} // namespace
+
+CpuSimdLevel DetectCpuSimdLevel() {
+#ifdef CPU_CONVERTER_X86
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return CpuSimdLevel::AVX2;
+    return CpuSimdLevel::SSE2;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5)) return CpuSimdLevel::AVX2;
+    }
+    return CpuSimdLevel::SSE2;
+#else
+    return CpuSimdLevel::SSE2;
+#endif
+#else
+    return CpuSimdLevel::Scalar;
+#endif
+}
+
+const char* CpuSimdLevelName(CpuSimdLevel level) {
+    switch (level) {
+        case CpuSimdLevel::AVX2: return "avx2";
+        case CpuSimdLevel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+bool ParseCpuSimdLevel(const char* name, CpuSimdLevel& level) {
+    std::string value = name;
+    if (value == "scalar") level = CpuSimdLevel::Scalar;
+    else if (value == "sse2") level = CpuSimdLevel::SSE2;
+    else if (value == "avx2") level = CpuSimdLevel::AVX2;
+    else return false;
+
+    // Never run code the CPU cannot execute
+    level = std::min(level, DetectCpuSimdLevel());
+    return true;
+}
+
+void ConvertNV12ToRGBA(const uint8_t* y_plane, const uint8_t* uv_plane, uint8_t* rgba,
+                       int width, int height, const YuvToRgbCoefficients& coeffs,
+                       CpuSimdLevel level, ThreadPool* pool, ChromaFilter filter) {
+    convertFrame(uv_plane, rgba, width, height, coeffs, 1.0f / 255.0f, pool, filter,
+                 [&](int y, const float* u, const float* v, uint8_t* out) {
+        const uint8_t* yRow = y_plane + static_cast<size_t>(y) * width;
+        switch (level) {
+#ifdef CPU_CONVERTER_X86
+            case CpuSimdLevel::AVX2: convertRowAVX2(yRow, u, v, out, width, coeffs); break;
+            case CpuSimdLevel::SSE2: convertRowSSE2(yRow, u, v, out, width, coeffs); break;
+#endif
+            default: convertRowScalar(yRow, u, v, out, 0, width, coeffs); break;
+        }
+    });
+}
+
+void ConvertP010ToRGBA(const uint16_t* y_plane, const uint16_t* uv_plane, uint8_t* rgba,
+                       int width, int height, const YuvToRgbCoefficients& coeffs, ThreadPool* pool) {
+    // Words hold value10 << 6; 65472 (1023 << 6) maps to 1.0, as in the INPUT_P010 shader path
+    const float norm = 1.0f / 65472.0f;
+    convertFrame(uv_plane, rgba, width, height, coeffs, norm, pool, ChromaFilter::Linear,
+                 [&](int y, const float* u, const float* v, uint8_t* out) {
+        convertRowScalar16(y_plane + static_cast<size_t>(y) * width, norm, u, v, out, width, coeffs);
+    });
+}
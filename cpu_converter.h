@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+class ThreadPool;
+
+// Instruction set used by the CPU converter
+enum class CpuSimdLevel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Conversion coefficients, defaulting to the ones in fragmentShaderSource.
+// Inputs are normalized first: y = (Y - yOffset) * yScale, u/v = (C - uvOffset) * uvScale.
+struct YuvToRgbCoefficients {
+    float rv = 1.403f;
+    float gu = 0.344f;
+    float gv = 0.714f;
+    float bu = 1.770f;
+
+    float yOffset = 0.0f;
+    float yScale = 1.0f;
+    float uvOffset = 0.5f;
+    float uvScale = 1.0f;
+};
+
+// Chroma upsampling of the reference: GL_LINEAR (default) or GL_NEAREST rules
+enum class ChromaFilter {
+    Linear,
+    Nearest
+};
+
+// Best instruction set supported by this CPU (and this build)
+CpuSimdLevel DetectCpuSimdLevel();
+const char* CpuSimdLevelName(CpuSimdLevel level);
+bool ParseCpuSimdLevel(const char* name, CpuSimdLevel& level);
+
+// Convert NV12 to RGBA8 with the same sampling as the GPU path: luma is point
+// sampled, chroma is bilinearly upsampled following GL_LINEAR texel-center rules
+// with CLAMP_TO_EDGE (or replicated per GL_NEAREST with ChromaFilter::Nearest).
+// The UV plane is NV12ChromaWidth x NV12ChromaHeight, so odd sizes are supported.
+// Rows are split into bands across pool (null = calling thread).
+void ConvertNV12ToRGBA(const uint8_t* y_plane, const uint8_t* uv_plane, uint8_t* rgba,
+                       int width, int height, const YuvToRgbCoefficients& coeffs,
+                       CpuSimdLevel level, ThreadPool* pool, ChromaFilter filter = ChromaFilter::Linear);
+
+// Same conversion for P010 (NV12 layout, 10-bit samples in the high bits of
+// 16-bit words) at full sample precision, so 10-bit input is checked against a
+// reference that has not been rounded to 8 bits. Scalar rows.
+void ConvertP010ToRGBA(const uint16_t* y_plane, const uint16_t* uv_plane, uint8_t* rgba,
+                       int width, int height, const YuvToRgbCoefficients& coeffs, ThreadPool* pool);
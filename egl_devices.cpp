@@ -0,0 +1,118 @@
+#include "egl_devices.h"
+#include "gl_common.h"
+#include <fstream>
+
+#ifndef EGL_PLATFORM_DEVICE_EXT
+#define EGL_PLATFORM_DEVICE_EXT 0x313F
+#endif
+
+#ifndef EGL_DRM_DEVICE_FILE_EXT
+#define EGL_DRM_DEVICE_FILE_EXT 0x3233
+#endif
+
+#ifndef EGL_DRM_RENDER_NODE_FILE_EXT
+#define EGL_DRM_RENDER_NODE_FILE_EXT 0x3377
+#endif
+
+#ifndef EGL_RENDERER_EXT
+#define EGL_RENDERER_EXT 0x335F
+#endif
+
+namespace {
+
+std::string deviceString(PFNEGLQUERYDEVICESTRINGEXTPROC query, EGLDeviceEXT device, EGLint name) {
+    const char* value = query(device, name);
+    if (!value) {
+        eglGetError();  // clear EGL_BAD_PARAMETER for unsupported names
+        return "";
+    }
+    return value;
+}
+
+// Same vendor table as the DXGI enumeration
+const char* pciVendorName(unsigned id) {
+    switch (id) {
+        case 0x10DE: return "NVIDIA";
+        case 0x1002: return "AMD";
+        case 0x8086: return "Intel";
+        case 0x13B5: return "ARM";
+        case 0x5143: return "Qualcomm";
+        case 0x1AF4: return "virtio";
+        default: return "Unknown";
+    }
+}
+
+// PCI vendor of a DRM node from sysfs (Linux); empty when unknown
+std::string drmNodeVendor(const std::string& node) {
+    size_t slash = node.rfind('/');
+    if (node.empty() || slash == std::string::npos) return "";
+    std::ifstream file("/sys/class/drm/" + node.substr(slash + 1) + "/device/vendor");
+    unsigned id = 0;
+    if (!(file >> std::hex >> id)) return "";
+    return pciVendorName(id);
+}
+
+} // namespace
+
+std::vector<EglDeviceInfo> EnumerateEglDevices() {
+    std::vector<EglDeviceInfo> devices;
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!hasExtension(clientExtensions, "EGL_EXT_device_enumeration") &&
+        !hasExtension(clientExtensions, "EGL_EXT_device_base")) {
+        eglGetError();
+        return devices;
+    }
+
+    auto queryDevices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+    auto queryString = (PFNEGLQUERYDEVICESTRINGEXTPROC)eglGetProcAddress("eglQueryDeviceStringEXT");
+    if (!queryDevices || !queryString) return devices;
+
+    EGLint count = 0;
+    if (!queryDevices(0, nullptr, &count) || count <= 0) return devices;
+    std::vector<EGLDeviceEXT> handles(count);
+    if (!queryDevices(count, handles.data(), &count)) return devices;
+    handles.resize(count);
+
+    for (EGLDeviceEXT handle : handles) {
+        EglDeviceInfo info;
+        info.device = handle;
+        info.extensions = deviceString(queryString, handle, EGL_EXTENSIONS);
+        info.software = hasExtension(info.extensions.c_str(), "EGL_MESA_device_software");
+        if (hasExtension(info.extensions.c_str(), "EGL_EXT_device_drm_render_node")) {
+            info.drmNode = deviceString(queryString, handle, EGL_DRM_RENDER_NODE_FILE_EXT);
+        }
+        if (info.drmNode.empty() && hasExtension(info.extensions.c_str(), "EGL_EXT_device_drm")) {
+            info.drmNode = deviceString(queryString, handle, EGL_DRM_DEVICE_FILE_EXT);
+        }
+        if (hasExtension(info.extensions.c_str(), "EGL_EXT_device_query_name")) {
+            info.name = deviceString(queryString, handle, EGL_RENDERER_EXT);
+            info.vendor = deviceString(queryString, handle, EGL_VENDOR);
+        }
+
+        if (info.vendor.empty()) {
+            info.vendor = info.software ? "Mesa" : drmNodeVendor(info.drmNode);
+        }
+        if (info.vendor.empty()) {
+            info.vendor = "Unknown";
+        }
+        if (info.name.empty()) {
+            if (info.software) {
+                info.name = "Mesa software rasterizer";
+            } else {
+                info.name = info.vendor + " GPU" + (info.drmNode.empty() ? "" : " (" + info.drmNode + ")");
+            }
+        }
+        devices.push_back(info);
+    }
+    return devices;
+}
+
+EGLDisplay GetEglDeviceDisplay(EGLDeviceEXT device) {
+    if (device == EGL_NO_DEVICE_EXT ||
+        !hasExtension(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS), "EGL_EXT_platform_device")) {
+        return EGL_NO_DISPLAY;
+    }
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (!getPlatformDisplay) return EGL_NO_DISPLAY;
+    return getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <string>
+#include <vector>
+
+// One device from EGL_EXT_device_enumeration
+struct EglDeviceInfo {
+    EGLDeviceEXT device = EGL_NO_DEVICE_EXT;
+    std::string name;        // EGL_RENDERER_EXT, else built from the vendor and DRM node
+    std::string vendor;      // EGL_VENDOR, else from the PCI vendor id of the DRM node
+    std::string drmNode;     // e.g. /dev/dri/renderD128 (empty for software devices)
+    std::string extensions;  // device extensions
+    bool software = false;   // EGL_MESA_device_software (llvmpipe, softpipe)
+};
+
+// Every EGL device, in driver order. Empty when the EGL implementation lacks
+// EGL_EXT_device_enumeration.
+std::vector<EglDeviceInfo> EnumerateEglDevices();
+
+// Display for one device through EGL_EXT_platform_device, or EGL_NO_DISPLAY.
+// Device displays are headless: use surfaceless contexts or pbuffers.
+EGLDisplay GetEglDeviceDisplay(EGLDeviceEXT device);
@@ -0,0 +1,19 @@
+#include "gl_common.h"
+#include <cstring>
+
+bool hasExtension(const char* extensions, const char* name) {
+    if (!extensions || !name) return false;
+    size_t len = strlen(name);
+    const char* p = extensions;
+    while ((p = strstr(p, name)) != nullptr) {
+        bool startOk = (p == extensions) || (p[-1] == ' ');
+        bool endOk = (p[len] == ' ') || (p[len] == '\0');
+        if (startOk && endOk) return true;
+        p += len;
+    }
+    return false;
+}
+
+bool hasGLExtension(const char* name) {
+    return hasExtension(reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS)), name);
+}
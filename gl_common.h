@@ -0,0 +1,13 @@
+#pragma once
+
+#ifdef _WIN32
+#include <ANGLE/GLES3/gl3.h>
+#else
+#include <GLES3/gl3.h>
+#endif
+
+// Check whether a space-separated extension string contains an exact token
+bool hasExtension(const char* extensions, const char* name);
+
+// Check whether the current GL context exposes an extension
+bool hasGLExtension(const char* name);
@@ -0,0 +1,297 @@
+#include "gpu_timer.h"
+#include "trace.h"
+#include <EGL/egl.h>
+#include <algorithm>
+#include <iostream>
+
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#endif
+
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+#ifndef GL_TIMESTAMP_EXT
+#define GL_TIMESTAMP_EXT 0x8E28
+#endif
+
+#ifndef GL_QUERY_COUNTER_BITS_EXT
+#define GL_QUERY_COUNTER_BITS_EXT 0x8864
+#endif
+
+typedef void (GL_APIENTRYP PFN_glGetQueryObjectui64vEXT)(GLuint id, GLenum pname, GLuint64* params);
+typedef void (GL_APIENTRYP PFN_glQueryCounterEXT)(GLuint id, GLenum target);
+static PFN_glGetQueryObjectui64vEXT pglGetQueryObjectui64vEXT = nullptr;
+static PFN_glQueryCounterEXT pglQueryCounterEXT = nullptr;
+
+namespace {
+
+// Initialized timers of this thread's context, fed by PollGpuDisjoint
+struct DisjointListeners {
+    std::vector<GpuTimer*> timers;
+    std::vector<GpuTraceTimer*> traceTimers;
+};
+thread_local DisjointListeners disjointListeners;
+
+template <typename T>
+void removeListener(std::vector<T*>& listeners, T* timer) {
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), timer), listeners.end());
+}
+
+} // namespace
+
+void PollGpuDisjoint() {
+    if (disjointListeners.timers.empty() && disjointListeners.traceTimers.empty()) return;
+
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    for (GpuTimer* timer : disjointListeners.timers) {
+        timer->applyDisjoint(disjoint != 0);
+    }
+    for (GpuTraceTimer* timer : disjointListeners.traceTimers) {
+        timer->applyDisjoint(disjoint != 0);
+    }
+}
+
+GpuTimer::GpuTimer(int ringSize) : ringSize(ringSize > 0 ? ringSize : 1) {}
+
+GpuTimer::~GpuTimer() {
+    removeListener(disjointListeners.timers, this);
+    if (!queries.empty()) {
+        glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    }
+}
+
+bool GpuTimer::init() {
+    if (!hasGLExtension("GL_EXT_disjoint_timer_query")) {
+        std::cout << "GL_EXT_disjoint_timer_query not supported, GPU timing disabled" << std::endl;
+        return false;
+    }
+
+    pglGetQueryObjectui64vEXT =
+        (PFN_glGetQueryObjectui64vEXT)eglGetProcAddress("glGetQueryObjectui64vEXT");
+
+    queries.resize(ringSize);
+    pending.assign(ringSize, false);
+    invalid.assign(ringSize, false);
+    glGenQueries(ringSize, queries.data());
+
+    // A stale disjoint flag goes to the timers already running, not to this one
+    PollGpuDisjoint();
+
+    available = glGetError() == GL_NO_ERROR;
+    if (!available) {
+        std::cout << "Timer query setup failed, GPU timing disabled" << std::endl;
+        return false;
+    }
+    disjointListeners.timers.push_back(this);
+    return true;
+}
+
+void GpuTimer::begin() {
+    if (!available) return;
+
+    // Ring is full: the oldest query must be retired before its slot is reused
+    if (pending[head]) {
+        readSlot(head, true);
+    }
+    glBeginQuery(GL_TIME_ELAPSED_EXT, queries[head]);
+}
+
+void GpuTimer::end() {
+    if (!available) return;
+
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    pending[head] = true;
+    head = (head + 1) % ringSize;
+}
+
+void GpuTimer::collect(bool wait) {
+    if (!available) return;
+
+    while (pending[tail]) {
+        if (!readSlot(tail, wait)) break;
+    }
+    if (wait) {
+        PollGpuDisjoint();
+    }
+}
+
+void GpuTimer::reset() {
+    collect(true);
+    gpuTimes.clear();
+    disjointFrames = 0;
+}
+
+void GpuTimer::applyDisjoint(bool disjoint) {
+    if (!disjoint) {
+        gpuTimes.insert(gpuTimes.end(), unconfirmed.begin(), unconfirmed.end());
+    } else {
+        disjointFrames += static_cast<int>(unconfirmed.size());
+        for (int slot = 0; slot < ringSize; slot++) {
+            if (pending[slot]) invalid[slot] = true;
+        }
+    }
+    unconfirmed.clear();
+}
+
+bool GpuTimer::readSlot(int slot, bool wait) {
+    // Results complete in order, so only the oldest pending slot is ever read
+    if (slot != tail) {
+        while (tail != slot) readSlot(tail, true);
+    }
+
+    GLuint ready = GL_FALSE;
+    do {
+        glGetQueryObjectuiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &ready);
+    } while (!ready && wait);
+
+    if (!ready) return false;
+
+    GLuint64 elapsedNs = 0;
+    if (pglGetQueryObjectui64vEXT) {
+        pglGetQueryObjectui64vEXT(queries[slot], GL_QUERY_RESULT, &elapsedNs);
+    } else {
+        GLuint elapsed32 = 0;
+        glGetQueryObjectuiv(queries[slot], GL_QUERY_RESULT, &elapsed32);
+        elapsedNs = elapsed32;
+    }
+
+    // A disjoint event (clock change, context loss) invalidates in-flight
+    // results; whether one happened is known at the next PollGpuDisjoint
+    if (invalid[slot]) {
+        disjointFrames++;
+    } else {
+        unconfirmed.push_back(elapsedNs / 1.0e6);
+    }
+
+    pending[slot] = false;
+    invalid[slot] = false;
+    tail = (tail + 1) % ringSize;
+    return true;
+}
+
+GpuTraceTimer::GpuTraceTimer(int ringSize) : ringSize(ringSize > 0 ? ringSize : 1) {}
+
+GpuTraceTimer::~GpuTraceTimer() {
+    removeListener(disjointListeners.traceTimers, this);
+    for (Slot& slot : slots) {
+        glDeleteQueries(2, slot.queries);
+    }
+}
+
+bool GpuTraceTimer::init() {
+    if (!TraceEnabled()) {
+        return false;
+    }
+    if (!hasGLExtension("GL_EXT_disjoint_timer_query")) {
+        std::cout << "GL_EXT_disjoint_timer_query not supported, no GPU spans in the trace" << std::endl;
+        return false;
+    }
+
+    pglGetQueryObjectui64vEXT =
+        (PFN_glGetQueryObjectui64vEXT)eglGetProcAddress("glGetQueryObjectui64vEXT");
+    pglQueryCounterEXT = (PFN_glQueryCounterEXT)eglGetProcAddress("glQueryCounterEXT");
+
+    // Timestamps are optional in the extension: zero counter bits means unsupported
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP_EXT, GL_QUERY_COUNTER_BITS_EXT, &bits);
+    glGetError();
+    if (!pglQueryCounterEXT || !pglGetQueryObjectui64vEXT || bits == 0) {
+        std::cout << "GPU timestamp queries not supported, no GPU spans in the trace" << std::endl;
+        return false;
+    }
+
+    // Offset between the GPU clock and the trace clock, read with the pipeline idle
+    glFinish();
+    uint64_t before = TraceNowNs();
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP_EXT, &gpuNow);
+    uint64_t after = TraceNowNs();
+    gpuToTraceNs = static_cast<int64_t>((before + after) / 2) - gpuNow;
+
+    slots.resize(ringSize);
+    for (Slot& slot : slots) {
+        glGenQueries(2, slot.queries);
+    }
+
+    // A stale disjoint flag goes to the timers already running, not to this one
+    PollGpuDisjoint();
+
+    available = glGetError() == GL_NO_ERROR;
+    if (available) {
+        disjointListeners.traceTimers.push_back(this);
+    }
+    return available;
+}
+
+void GpuTraceTimer::begin(const char* name, int64_t frame) {
+    if (!available) return;
+
+    // Ring is full: retire spans in order until this slot is free
+    while (slots[head].pending) {
+        readSlot(slots[tail], true);
+    }
+    Slot& slot = slots[head];
+    slot.name = name;
+    slot.frame = frame;
+    pglQueryCounterEXT(slot.queries[0], GL_TIMESTAMP_EXT);
+}
+
+void GpuTraceTimer::end() {
+    if (!available) return;
+
+    pglQueryCounterEXT(slots[head].queries[1], GL_TIMESTAMP_EXT);
+    slots[head].pending = true;
+    head = (head + 1) % ringSize;
+}
+
+void GpuTraceTimer::collect(bool wait) {
+    if (!available) return;
+
+    while (slots[tail].pending) {
+        if (!readSlot(slots[tail], wait)) break;
+    }
+    if (wait) {
+        PollGpuDisjoint();
+    }
+}
+
+void GpuTraceTimer::applyDisjoint(bool disjoint) {
+    if (!disjoint) {
+        for (const Span& span : unconfirmed) {
+            TraceRecordSpan(span.name, "gpu", span.begin, span.end, span.frame, kTraceGpuTrack);
+        }
+    } else {
+        for (Slot& slot : slots) {
+            if (slot.pending) slot.invalid = true;
+        }
+    }
+    unconfirmed.clear();
+}
+
+bool GpuTraceTimer::readSlot(Slot& slot, bool wait) {
+    GLuint ready = GL_FALSE;
+    do {
+        glGetQueryObjectuiv(slot.queries[1], GL_QUERY_RESULT_AVAILABLE, &ready);
+    } while (!ready && wait);
+
+    if (!ready) return false;
+
+    GLuint64 begin = 0, end = 0;
+    pglGetQueryObjectui64vEXT(slot.queries[0], GL_QUERY_RESULT, &begin);
+    pglGetQueryObjectui64vEXT(slot.queries[1], GL_QUERY_RESULT, &end);
+
+    // Spans crossing a disjoint event have meaningless timestamps; whether one
+    // happened is known at the next PollGpuDisjoint
+    if (!slot.invalid) {
+        unconfirmed.push_back({ slot.name, static_cast<uint64_t>(static_cast<int64_t>(begin) + gpuToTraceNs),
+                                static_cast<uint64_t>(static_cast<int64_t>(end) + gpuToTraceNs), slot.frame });
+    }
+
+    slot.pending = false;
+    slot.invalid = false;
+    tail = (tail + 1) % ringSize;
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "gl_common.h"
+#include <cstdint>
+#include <vector>
+
+// GL_GPU_DISJOINT_EXT is per context and cleared when read, so every timer on
+// the calling thread's context shares one reader. Call once per frame, after the
+// timers' collect(). The result goes to every initialized timer: results read
+// since the last poll are kept or dropped, and queries in flight during a
+// disjoint event are dropped when they complete. collect(true) also polls.
+void PollGpuDisjoint();
+
+// GPU-side timing with GL_EXT_disjoint_timer_query.
+// Queries are kept in a ring and read back a few frames after they were issued,
+// so reading results never forces a CPU/GPU sync on the frame being measured.
+class GpuTimer {
+public:
+    explicit GpuTimer(int ringSize = 4);
+    ~GpuTimer();
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    // Returns false (and stays disabled) if the extension is missing
+    bool init();
+    bool isAvailable() const { return available; }
+
+    // Bracket the GPU work of one frame
+    void begin();
+    void end();
+
+    // Read back finished queries. With wait=true, blocks until all are done.
+    void collect(bool wait);
+
+    // GPU times in milliseconds, in submission order (disjoint frames dropped).
+    // Results read since the last PollGpuDisjoint() are not included yet.
+    const std::vector<double>& samples() const { return gpuTimes; }
+    int disjointCount() const { return disjointFrames; }
+    void reset();
+
+private:
+    friend void PollGpuDisjoint();
+    bool readSlot(int slot, bool wait);
+    void applyDisjoint(bool disjoint);
+
+    int ringSize;
+    bool available = false;
+    std::vector<GLuint> queries;
+    std::vector<bool> pending;
+    std::vector<bool> invalid;  // in flight during a disjoint event
+    int head = 0;    // next slot to issue
+    int tail = 0;    // oldest pending slot
+    std::vector<double> unconfirmed;  // read, waiting for the next disjoint poll
+    std::vector<double> gpuTimes;
+    int disjointFrames = 0;
+};
+
+// GPU spans for the trace (trace.h): GL_TIMESTAMP_EXT queries before and after
+// each span, mapped onto the CPU trace clock with an offset measured in init().
+// Like GpuTimer, results are read a few spans later so tracing adds no sync.
+class GpuTraceTimer {
+public:
+    explicit GpuTraceTimer(int ringSize = 8);
+    ~GpuTraceTimer();
+    GpuTraceTimer(const GpuTraceTimer&) = delete;
+    GpuTraceTimer& operator=(const GpuTraceTimer&) = delete;
+
+    // False (and inactive) when tracing is off or timestamp queries are missing
+    bool init();
+    bool isAvailable() const { return available; }
+
+    // name must be a string literal (see TraceRecordSpan)
+    void begin(const char* name, int64_t frame = -1);
+    void end();
+
+    // Record finished spans. With wait=true, blocks until all are done.
+    void collect(bool wait);
+
+private:
+    friend void PollGpuDisjoint();
+
+    struct Slot {
+        GLuint queries[2] = { 0, 0 };
+        const char* name = nullptr;
+        int64_t frame = -1;
+        bool pending = false;
+        bool invalid = false;  // in flight during a disjoint event
+    };
+    struct Span {
+        const char* name;
+        uint64_t begin;
+        uint64_t end;
+        int64_t frame;
+    };
+    bool readSlot(Slot& slot, bool wait);
+    void applyDisjoint(bool disjoint);
+
+    int ringSize;
+    bool available = false;
+    std::vector<Slot> slots;
+    std::vector<Span> unconfirmed;  // read, waiting for the next disjoint poll
+    int head = 0;
+    int tail = 0;
+    int64_t gpuToTraceNs = 0;  // trace time = GPU timestamp + offset
+};
@@ -0,0 +1,134 @@
+#include "host_memory.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t kCacheLine = 64;
+const size_t kHugePage = 2 * 1024 * 1024;
+
+size_t pageSize() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+#endif
+}
+
+uint8_t* alignedAlloc(size_t alignment, size_t bytes) {
+#ifdef _WIN32
+    return static_cast<uint8_t*>(_aligned_malloc(bytes, alignment));
+#else
+    void* data = nullptr;
+    return posix_memalign(&data, alignment, bytes) == 0 ? static_cast<uint8_t*>(data) : nullptr;
+#endif
+}
+
+void alignedFree(uint8_t* data) {
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    free(data);
+#endif
+}
+
+} // namespace
+
+HostArena::~HostArena() {
+    releaseAll();
+}
+
+uint8_t* HostArena::get(const std::string& tag, size_t bytes) {
+    auto block = std::find_if(blocks.begin(), blocks.end(), [&](const Block& b) { return b.tag == tag; });
+    if (block != blocks.end() && block->capacity >= bytes) {
+        return block->data;
+    }
+
+    size_t alignment = kCacheLine;
+    if (bytes >= pageSize()) alignment = pageSize();
+    if (hugePages && bytes >= kHugePage) alignment = kHugePage;
+    const size_t capacity = (std::max<size_t>(bytes, 1) + alignment - 1) / alignment * alignment;
+
+    // Free first: the old contents are not kept, and the peak stays honest
+    if (block != blocks.end()) {
+        alignedFree(block->data);
+        allocated -= block->capacity;
+        blocks.erase(block);
+    }
+    uint8_t* data = alignedAlloc(alignment, capacity);
+    if (!data) {
+        std::cerr << "Host allocation of " << capacity << " bytes for " << tag << " failed" << std::endl;
+        throw std::bad_alloc();
+    }
+#if defined(MADV_HUGEPAGE)
+    if (alignment == kHugePage) {
+        madvise(data, capacity, MADV_HUGEPAGE);
+    }
+#endif
+
+    blocks.push_back({ tag, data, capacity });
+    allocated += capacity;
+    peak = std::max(peak, allocated);
+    allocations++;
+    return data;
+}
+
+void HostArena::releaseAll() {
+    for (Block& block : blocks) {
+        alignedFree(block.data);
+    }
+    blocks.clear();
+    allocated = 0;
+}
+
+ProcessMemory QueryProcessMemory() {
+    ProcessMemory memory;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        memory.residentBytes = counters.WorkingSetSize;
+        memory.peakResidentBytes = counters.PeakWorkingSetSize;
+    }
+#else
+    FILE* status = fopen("/proc/self/status", "r");
+    if (!status) return memory;
+    char line[256];
+    while (fgets(line, sizeof(line), status)) {
+        unsigned long long kb = 0;
+        if (sscanf(line, "VmRSS: %llu kB", &kb) == 1) {
+            memory.residentBytes = static_cast<size_t>(kb) * 1024;
+        } else if (sscanf(line, "VmHWM: %llu kB", &kb) == 1) {
+            memory.peakResidentBytes = static_cast<size_t>(kb) * 1024;
+        }
+    }
+    fclose(status);
+#endif
+    return memory;
+}
+
+bool ResetPeakResidentMemory() {
+#ifdef __linux__
+    // "5" resets VmHWM to the current RSS (Linux 4.0+)
+    FILE* clearRefs = fopen("/proc/self/clear_refs", "w");
+    if (!clearRefs) return false;
+    bool ok = fputs("5", clearRefs) >= 0;
+    return fclose(clearRefs) == 0 && ok;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Aligned host buffers that are reused instead of freed. Each buffer is named
+// by a tag ("frame/nv12", "verify/reference", ...): asking for a tag again
+// returns the same memory as long as it is big enough, so repeated tests, sweep
+// points and streams do not go back to the allocator for every large frame.
+// When a tag must grow, get() frees its buffer and allocates a new one: every
+// pointer returned earlier for that tag dangles afterwards and the contents are
+// lost. Pointers for other tags stay valid. Callers that hand out offsets into
+// one buffer (e.g. per-thread slices) take the pointer once, at the final size.
+//
+// Every buffer is at least 64-byte aligned (one cache line, enough for AVX-512
+// loads). Buffers of a page or more are page aligned, which is what drivers
+// want for zero-copy client memory. With huge pages on, buffers of 2 MiB or
+// more are 2 MiB aligned and advised for transparent huge pages.
+class HostArena {
+public:
+    HostArena() = default;
+    ~HostArena();
+    HostArena(const HostArena&) = delete;
+    HostArena& operator=(const HostArena&) = delete;
+
+    uint8_t* get(const std::string& tag, size_t bytes);
+
+    // Size a tag for the largest of several upcoming uses (e.g. a sweep)
+    void reserve(const std::string& tag, size_t bytes) { get(tag, bytes); }
+
+    void setHugePages(bool enabled) { hugePages = enabled; }
+
+    // Free every buffer
+    void releaseAll();
+
+    size_t allocatedBytes() const { return allocated; }
+    size_t peakBytes() const { return peak; }
+    int allocationCount() const { return allocations; }  // reallocations included
+    void resetPeak() { peak = allocated; }
+
+private:
+    struct Block {
+        std::string tag;
+        uint8_t* data;
+        size_t capacity;
+    };
+
+    std::vector<Block> blocks;
+    bool hugePages = false;
+    size_t allocated = 0;
+    size_t peak = 0;
+    int allocations = 0;
+};
+
+// Resident set size of this process, in bytes (0 where unsupported)
+struct ProcessMemory {
+    size_t residentBytes = 0;
+    size_t peakResidentBytes = 0;  // since start or the last ResetPeakResidentMemory
+};
+ProcessMemory QueryProcessMemory();
+
+// Restart peak RSS tracking so the next peak belongs to one configuration.
+// Linux only (writes /proc/self/clear_refs); returns false elsewhere, where
+// the peak keeps covering the whole run.
+bool ResetPeakResidentMemory();
@@ -0,0 +1,588 @@
+#include "image_writer.h"
+#include "texture_utils.h"
+#include "trace.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IMAGE_WRITER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define TARGET_SSSE3
+#endif
+
+namespace {
+
+const size_t kWriteBufferBytes = 1 << 20;
+
+// stdio buffering is turned off; rows are encoded straight into one large
+// buffer that is handed to fwrite when full
+class OutputFile {
+public:
+    ~OutputFile() { close(); }
+
+    bool open(const std::string& path) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Failed to open output " << path << std::endl;
+            return false;
+        }
+        setvbuf(file, nullptr, _IONBF, 0);
+        buffer.resize(kWriteBufferBytes);
+        used = 0;
+        ok = true;
+        return true;
+    }
+
+    // Space for n bytes at the end of the buffer; commit(n) once they are filled
+    uint8_t* reserve(size_t n) {
+        if (used + n > buffer.size()) {
+            flush();
+            if (n > buffer.size()) buffer.resize(n);
+        }
+        return buffer.data() + used;
+    }
+
+    void commit(size_t n) {
+        used += n;
+        bytes += n;
+    }
+
+    void write(const void* data, size_t n) {
+        memcpy(reserve(n), data, n);
+        commit(n);
+    }
+
+    void flush() {
+        if (used > 0 && file && fwrite(buffer.data(), 1, used, file) != used) {
+            ok = false;
+        }
+        used = 0;
+    }
+
+    bool close() {
+        if (!file) return ok;
+        flush();
+        if (fclose(file) != 0) ok = false;
+        file = nullptr;
+        return ok;
+    }
+
+    uint64_t bytes = 0;
+    bool ok = false;
+
+private:
+    FILE* file = nullptr;
+    std::vector<uint8_t> buffer;
+    size_t used = 0;
+};
+
+// --- RGBA -> packed 24-bit rows ---
+
+void packRowScalar(const uint8_t* src, uint8_t* dst, int count, bool bgr) {
+    const int r = bgr ? 2 : 0;
+    const int b = bgr ? 0 : 2;
+    for (int x = 0; x < count; x++) {
+        dst[x * 3 + 0] = src[x * 4 + r];
+        dst[x * 3 + 1] = src[x * 4 + 1];
+        dst[x * 3 + 2] = src[x * 4 + b];
+    }
+}
+
+#ifdef IMAGE_WRITER_X86
+// 16 pixels per iteration: each 4-pixel load is shuffled down to 12 bytes and
+// the four results are spliced into three full 16-byte stores
+TARGET_SSSE3
+void packRowSSSE3(const uint8_t* src, uint8_t* dst, int count, bool bgr) {
+    const __m128i shuffle = bgr ? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+                                : _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const __m128i* in = reinterpret_cast<const __m128i*>(src + x * 4);
+        __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128(in + 0), shuffle);
+        __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128(in + 1), shuffle);
+        __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128(in + 2), shuffle);
+        __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128(in + 3), shuffle);
+        __m128i* out = reinterpret_cast<__m128i*>(dst + x * 3);
+        _mm_storeu_si128(out + 0, _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+    }
+    packRowScalar(src + x * 4, dst + x * 3, count - x, bgr);
+}
+
+bool cpuHasSSSE3() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+void packRow(const uint8_t* src, uint8_t* dst, int count, bool bgr) {
+#ifdef IMAGE_WRITER_X86
+    static const bool ssse3 = cpuHasSSSE3();
+    if (ssse3) {
+        packRowSSSE3(src, dst, count, bgr);
+        return;
+    }
+#endif
+    packRowScalar(src, dst, count, bgr);
+}
+
+const uint8_t* rgbaRow(const uint8_t* rgba, int width, int y) {
+    return rgba + static_cast<size_t>(y) * width * 4;
+}
+
+// --- BMP / PPM / raw ---
+
+void encodeBMP(OutputFile& file, const uint8_t* rgba, int width, int height) {
+    const size_t rowBytes = static_cast<size_t>(width) * 3;
+    const size_t stride = (rowBytes + 3) & ~static_cast<size_t>(3);
+
+    BITMAPFILEHEADER bmp_header = {};
+    BITMAPINFOHEADER bmp_info = {};
+    bmp_header.bfType = 0x4D42; // "BM"
+    bmp_header.bfOffBits = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
+    bmp_header.bfSize = static_cast<uint32_t>(bmp_header.bfOffBits + stride * height);
+    bmp_info.biSize = sizeof(BITMAPINFOHEADER);
+    bmp_info.biWidth = width;
+    bmp_info.biHeight = -height; // Negative value means top-down storage
+    bmp_info.biPlanes = 1;
+    bmp_info.biBitCount = 24;
+    bmp_info.biCompression = BI_RGB;
+    file.write(&bmp_header, sizeof(bmp_header));
+    file.write(&bmp_info, sizeof(bmp_info));
+
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = file.reserve(stride);
+        packRow(rgbaRow(rgba, width, y), row, width, true);
+        memset(row + rowBytes, 0, stride - rowBytes);  // rows are 4-byte aligned
+        file.commit(stride);
+    }
+}
+
+void encodePacked(OutputFile& file, const uint8_t* rgba, int width, int height) {
+    const size_t rowBytes = static_cast<size_t>(width) * 3;
+    for (int y = 0; y < height; y++) {
+        packRow(rgbaRow(rgba, width, y), file.reserve(rowBytes), width, false);
+        file.commit(rowBytes);
+    }
+}
+
+void encodePPM(OutputFile& file, const uint8_t* rgba, int width, int height) {
+    char header[64];
+    int length = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+    file.write(header, length);
+    encodePacked(file, rgba, width, height);
+}
+
+// --- Y4M: 4:4:4 planes, full-range BT.601 in 8.8 fixed point ---
+
+void writeY4MHeader(OutputFile& file, int width, int height) {
+    char header[96];
+    int length = snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F30:1 Ip A1:1 C444 XCOLORRANGE=FULL\n",
+                          width, height);
+    file.write(header, length);
+}
+
+inline uint8_t clampByte(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+void encodeY4MFrame(OutputFile& file, const uint8_t* rgba, int width, int height) {
+    file.write("FRAME\n", 6);
+    // One pass per plane keeps the output sequential without a planar copy
+    const int weights[3][3] = { { 77, 150, 29 }, { -43, -85, 128 }, { 128, -107, -21 } };
+    const int bias[3] = { 0, 128, 128 };
+    for (int plane = 0; plane < 3; plane++) {
+        const int* w = weights[plane];
+        for (int y = 0; y < height; y++) {
+            const uint8_t* src = rgbaRow(rgba, width, y);
+            uint8_t* dst = file.reserve(width);
+            for (int x = 0; x < width; x++) {
+                int sum = w[0] * src[x * 4] + w[1] * src[x * 4 + 1] + w[2] * src[x * 4 + 2] + 128;
+                dst[x] = clampByte(bias[plane] + (sum >> 8));
+            }
+            file.commit(width);
+        }
+    }
+}
+
+// --- PNG ---
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t n) {
+    static const auto table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void putBigEndian(uint8_t* dst, uint32_t value) {
+    dst[0] = static_cast<uint8_t>(value >> 24);
+    dst[1] = static_cast<uint8_t>(value >> 16);
+    dst[2] = static_cast<uint8_t>(value >> 8);
+    dst[3] = static_cast<uint8_t>(value);
+}
+
+void writePngChunk(OutputFile& file, const char* type, const uint8_t* data, uint32_t length) {
+    uint8_t header[8];
+    putBigEndian(header, length);
+    memcpy(header + 4, type, 4);
+    file.write(header, 8);
+    if (length) file.write(data, length);
+    uint8_t crc[4];
+    putBigEndian(crc, crc32Update(crc32Update(0, header + 4, 4), data, length));
+    file.write(crc, 4);
+}
+
+// The zlib stream of the IDAT chunk: stored deflate blocks of up to 65535 bytes.
+// Written incrementally, so the chunk CRC and the Adler-32 are updated on the way.
+class PngIdatStream {
+public:
+    static const size_t kMaxBlock = 65535;
+
+    static uint32_t zlibSize(size_t rawBytes) {
+        size_t blocks = (rawBytes + kMaxBlock - 1) / kMaxBlock;
+        return static_cast<uint32_t>(2 + rawBytes + blocks * 5 + 4);
+    }
+
+    PngIdatStream(OutputFile& file, size_t rawBytes) : file(file), rawLeft(rawBytes) {
+        uint8_t header[8];
+        putBigEndian(header, zlibSize(rawBytes));
+        memcpy(header + 4, "IDAT", 4);
+        file.write(header, 8);
+        crc = crc32Update(0, header + 4, 4);
+        const uint8_t zlibHeader[2] = { 0x78, 0x01 };
+        emit(zlibHeader, 2);
+    }
+
+    void put(const uint8_t* data, size_t n) {
+        while (n > 0) {
+            if (blockLeft == 0) {
+                blockLeft = std::min(rawLeft, kMaxBlock);
+                const uint16_t len = static_cast<uint16_t>(blockLeft);
+                const uint8_t blockHeader[5] = { static_cast<uint8_t>(blockLeft == rawLeft ? 1 : 0),
+                                                 static_cast<uint8_t>(len), static_cast<uint8_t>(len >> 8),
+                                                 static_cast<uint8_t>(~len), static_cast<uint8_t>(~len >> 8) };
+                emit(blockHeader, 5);
+            }
+            size_t take = std::min(n, blockLeft);
+            emit(data, take);
+            adler(data, take);
+            data += take;
+            n -= take;
+            blockLeft -= take;
+            rawLeft -= take;
+        }
+    }
+
+    void finish() {
+        uint8_t trailer[4];
+        putBigEndian(trailer, (adlerB << 16) | adlerA);
+        emit(trailer, 4);
+        uint8_t crcBytes[4];
+        putBigEndian(crcBytes, crc);
+        file.write(crcBytes, 4);
+    }
+
+private:
+    void emit(const uint8_t* data, size_t n) {
+        crc = crc32Update(crc, data, n);
+        file.write(data, n);
+    }
+
+    void adler(const uint8_t* data, size_t n) {
+        // 5552 bytes is the most that can be summed before the 32-bit sums overflow
+        while (n > 0) {
+            size_t chunk = std::min<size_t>(n, 5552);
+            for (size_t i = 0; i < chunk; i++) {
+                adlerA += data[i];
+                adlerB += adlerA;
+            }
+            adlerA %= 65521;
+            adlerB %= 65521;
+            data += chunk;
+            n -= chunk;
+        }
+    }
+
+    OutputFile& file;
+    size_t rawLeft;
+    size_t blockLeft = 0;
+    uint32_t crc = 0;
+    uint32_t adlerA = 1;
+    uint32_t adlerB = 0;
+};
+
+void encodePNG(OutputFile& file, const uint8_t* rgba, int width, int height) {
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write(signature, 8);
+
+    uint8_t ihdr[13];
+    putBigEndian(ihdr, width);
+    putBigEndian(ihdr + 4, height);
+    ihdr[8] = 8;   // bit depth
+    ihdr[9] = 2;   // RGB
+    ihdr[10] = 0;  // deflate
+    ihdr[11] = 0;  // adaptive filtering (every row uses filter 0)
+    ihdr[12] = 0;  // not interlaced
+    writePngChunk(file, "IHDR", ihdr, sizeof(ihdr));
+
+    // Each scanline is a filter byte followed by the RGB row
+    const size_t scanline = 1 + static_cast<size_t>(width) * 3;
+    std::vector<uint8_t> row(scanline, 0);
+    PngIdatStream idat(file, scanline * height);
+    for (int y = 0; y < height; y++) {
+        packRow(rgbaRow(rgba, width, y), row.data() + 1, width, false);
+        idat.put(row.data(), scanline);
+    }
+    idat.finish();
+
+    writePngChunk(file, "IEND", nullptr, 0);
+}
+
+// Still images only; sequences write their header once and then frames
+void encodeImage(OutputFile& file, ImageFileFormat format, const uint8_t* rgba, int width, int height) {
+    switch (format) {
+        case ImageFileFormat::BMP: encodeBMP(file, rgba, width, height); break;
+        case ImageFileFormat::PPM: encodePPM(file, rgba, width, height); break;
+        case ImageFileFormat::PNG: encodePNG(file, rgba, width, height); break;
+        case ImageFileFormat::Y4M: encodeY4MFrame(file, rgba, width, height); break;
+        case ImageFileFormat::Raw: encodePacked(file, rgba, width, height); break;
+    }
+}
+
+struct FormatInfo {
+    ImageFileFormat format;
+    const char* name;
+    const char* extensions[2];
+};
+
+const FormatInfo kFormats[] = {
+    { ImageFileFormat::BMP, "bmp", { ".bmp", nullptr } },
+    { ImageFileFormat::PPM, "ppm", { ".ppm", nullptr } },
+    { ImageFileFormat::PNG, "png", { ".png", nullptr } },
+    { ImageFileFormat::Y4M, "y4m", { ".y4m", nullptr } },
+    { ImageFileFormat::Raw, "raw", { ".rgb", ".raw" } },
+};
+
+} // namespace
+
+const char* ImageFileFormatName(ImageFileFormat format) {
+    for (const FormatInfo& info : kFormats) {
+        if (info.format == format) return info.name;
+    }
+    return "unknown";
+}
+
+bool ImageFileFormatFromPath(const std::string& path, ImageFileFormat& format) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string extension = path.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    for (const FormatInfo& info : kFormats) {
+        for (const char* candidate : info.extensions) {
+            if (candidate && extension == candidate) {
+                format = info.format;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool IsSequenceFormat(ImageFileFormat format) {
+    return format == ImageFileFormat::Y4M || format == ImageFileFormat::Raw;
+}
+
+bool WriteRGBAImage(const std::string& path, ImageFileFormat format, const uint8_t* rgba, int width, int height) {
+    OutputFile file;
+    if (!file.open(path)) return false;
+    if (format == ImageFileFormat::Y4M) {
+        writeY4MHeader(file, width, height);
+    }
+    encodeImage(file, format, rgba, width, height);
+    if (!file.close()) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+struct ImageWriter::SequenceFile {
+    std::string path;
+    ImageFileFormat format;
+    int width;
+    int height;
+    OutputFile file;
+};
+
+ImageWriter::ImageWriter(int queueDepth) : queueDepth(std::max(1, queueDepth)) {}
+
+ImageWriter::~ImageWriter() {
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+std::vector<uint8_t> ImageWriter::acquireBuffer(size_t bytes) {
+    TraceScope span("acquire_buffer", "write");
+    auto start = std::chrono::high_resolution_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    bufferAvailable.wait(lock, [this] { return buffersOut < queueDepth; });
+    totals.stallMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    buffersOut++;
+    std::vector<uint8_t> buffer;
+    if (!freeBuffers.empty()) {
+        buffer = std::move(freeBuffers.back());
+        freeBuffers.pop_back();
+    }
+    buffer.resize(bytes);
+    return buffer;
+}
+
+void ImageWriter::submit(const std::string& path, ImageFileFormat format, std::vector<uint8_t>&& rgba,
+                         int width, int height) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!writer.joinable()) {
+            writer = std::thread(&ImageWriter::writerLoop, this);
+        }
+        jobs.push_back({ path, format, std::move(rgba), width, height });
+    }
+    jobAvailable.notify_one();
+}
+
+void ImageWriter::submit(const std::string& path, ImageFileFormat format, const uint8_t* rgba, int width, int height) {
+    const size_t bytes = static_cast<size_t>(width) * height * 4;
+    std::vector<uint8_t> buffer = acquireBuffer(bytes);
+    memcpy(buffer.data(), rgba, bytes);
+    submit(path, format, std::move(buffer), width, height);
+}
+
+bool ImageWriter::finish() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return jobs.empty() && !busy; });
+    // The writer thread is parked until the next submit, so the sequence can be closed here
+    closeSequence();
+    return !totals.failed;
+}
+
+ImageWriterStats ImageWriter::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totals;
+}
+
+void ImageWriter::closeSequence() {
+    if (!sequence) return;
+    if (!sequence->file.close()) {
+        std::cerr << "Failed to write " << sequence->path << std::endl;
+        totals.failed = true;
+    }
+    sequence.reset();
+}
+
+void ImageWriter::writerLoop() {
+    TraceSetThreadName("image writer");
+    for (int64_t jobIndex = 0;; jobIndex++) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+        }
+
+        const uint64_t traceStart = TraceEnabled() ? TraceNowNs() : 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        bool ok = true;
+        uint64_t bytes = 0;
+        if (IsSequenceFormat(job.format)) {
+            if (sequence && (sequence->path != job.path || sequence->format != job.format ||
+                             sequence->width != job.width || sequence->height != job.height)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                closeSequence();
+            }
+            if (!sequence) {
+                sequence.reset(new SequenceFile{ job.path, job.format, job.width, job.height, {} });
+                ok = sequence->file.open(job.path);
+                if (ok && job.format == ImageFileFormat::Y4M) {
+                    writeY4MHeader(sequence->file, job.width, job.height);
+                }
+            }
+            if (ok) {
+                uint64_t before = sequence->file.bytes;
+                encodeImage(sequence->file, job.format, job.rgba.data(), job.width, job.height);
+                bytes = sequence->file.bytes - before;
+                ok = sequence->file.ok;
+            } else {
+                sequence.reset();
+            }
+        } else {
+            OutputFile file;
+            ok = file.open(job.path);
+            if (ok) {
+                encodeImage(file, job.format, job.rgba.data(), job.width, job.height);
+                ok = file.close();
+                bytes = file.bytes;
+            }
+            if (!ok) {
+                std::cerr << "Failed to write " << job.path << std::endl;
+            }
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        // Recorded before the job is marked done, so finish() sees the span
+        if (TraceEnabled()) {
+            TraceRecordSpan("encode_write", "write", traceStart, TraceNowNs(), jobIndex);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            totals.frames += ok ? 1 : 0;
+            totals.bytes += bytes;
+            totals.encodeMs += elapsed;
+            totals.failed = totals.failed || !ok;
+            freeBuffers.push_back(std::move(job.rgba));
+            buffersOut--;
+            busy = false;
+        }
+        bufferAvailable.notify_one();
+        idle.notify_all();
+    }
+}
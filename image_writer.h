@@ -0,0 +1,95 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Image and frame-sequence output for RGBA8 results. All encoders read the
+// RGBA buffer directly and swizzle whole rows into a large write buffer; there
+// is no full-frame RGB copy.
+enum class ImageFileFormat {
+    BMP,  // 24-bit BGR, top-down
+    PPM,  // binary P6
+    PNG,  // RGB8, stored (uncompressed) deflate blocks: no zlib dependency
+    Y4M,  // sequence: YUV4MPEG2 4:4:4, full-range BT.601 (the inverse of the default shader)
+    Raw,  // sequence: packed RGB24 frames back to back
+};
+
+const char* ImageFileFormatName(ImageFileFormat format);
+
+// Format from the file extension (.bmp, .ppm, .png, .y4m, .rgb/.raw)
+bool ImageFileFormatFromPath(const std::string& path, ImageFileFormat& format);
+
+// Sequence formats append every frame to one file; the others hold one image
+bool IsSequenceFormat(ImageFileFormat format);
+
+// Write one RGBA8 image (alpha is dropped) on the calling thread
+bool WriteRGBAImage(const std::string& path, ImageFileFormat format, const uint8_t* rgba, int width, int height);
+
+struct ImageWriterStats {
+    int frames = 0;
+    uint64_t bytes = 0;
+    double encodeMs = 0;  // writer thread: swizzle, encode and write
+    double stallMs = 0;   // caller: time spent waiting for a free frame buffer
+    bool failed = false;
+};
+
+// Writes frames on a background thread so dumping output does not stall the
+// caller. Frames go through a fixed pool of queueDepth buffers: acquireBuffer
+// only blocks when every buffer is still queued for writing.
+class ImageWriter {
+public:
+    explicit ImageWriter(int queueDepth = 3);
+    ~ImageWriter();
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator=(const ImageWriter&) = delete;
+
+    // A frame buffer of at least bytes, to be filled and passed to submit
+    std::vector<uint8_t> acquireBuffer(size_t bytes);
+
+    // Queue width x height RGBA8 pixels for path. For sequence formats every
+    // submit to the same path appends a frame to one open file.
+    void submit(const std::string& path, ImageFileFormat format, std::vector<uint8_t>&& rgba, int width, int height);
+
+    // Copying convenience for one-off images
+    void submit(const std::string& path, ImageFileFormat format, const uint8_t* rgba, int width, int height);
+
+    // Wait for every queued frame and close open sequences. False if a write failed.
+    bool finish();
+
+    ImageWriterStats stats();
+
+private:
+    struct SequenceFile;
+    struct Job {
+        std::string path;
+        ImageFileFormat format;
+        std::vector<uint8_t> rgba;
+        int width;
+        int height;
+    };
+
+    void writerLoop();
+    void closeSequence();
+
+    const int queueDepth;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable bufferAvailable;
+    std::condition_variable idle;
+    std::deque<Job> jobs;
+    std::vector<std::vector<uint8_t>> freeBuffers;
+    int buffersOut = 0;  // buffers handed to callers or queued
+    bool busy = false;
+    bool stopping = false;
+    ImageWriterStats totals;
+
+    // Open sequence, only touched by the writer thread
+    std::unique_ptr<SequenceFile> sequence;
+};
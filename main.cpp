@@ -1,21 +1,232 @@
-#include <ANGLE/GLES3/gl3.h>
+#include "gl_common.h"
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
+#ifdef _WIN32
 #include <EGL/eglext_angle.h>
+#endif
 #include <iostream>
 #include <vector>
 #include <chrono>
 #include <algorithm>
 #include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <ctime>
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <sys/wait.h>
+#endif
 #include "shaders.h"
 #include "texture_utils.h"
+#include "gpu_timer.h"
+#include "perf_stats.h"
+#include "cpu_converter.h"
+#include "thread_pool.h"
+#include "accuracy.h"
+#include "shader_variants.h"
+#include "program_cache.h"
+#include "compile_bench.h"
+#include "results_report.h"
+#include "pixel_formats.h"
+#include "compute_converter.h"
+#include "conversion_worker.h"
+#include "yuv_reader.h"
+#include "test_patterns.h"
+#include "image_writer.h"
+#include "trace.h"
+#include "host_memory.h"
+#include "chroma_sampling.h"
+#include "egl_devices.h"
+#ifdef _WIN32
 #include <dxgi1_2.h>
 #pragma comment(lib, "dxgi.lib")
+#endif
 
 // 添加 verbose 和 help 标志
 bool verbose = false;
 
+// Run the whole benchmark once per GPU (child processes) and compare them
+bool allGpus = false;
+
+// Headless mode: no window, context is made current surfaceless or on a pbuffer.
+// This is the only mode on non-Windows platforms.
+#ifdef _WIN32
+bool headless = false;
+#else
+bool headless = true;
+#endif
+
+// Measure GPU execution time with GL_EXT_disjoint_timer_query
+bool useGpuTimer = false;
+
+// Pipelined mode: queue depths to run with fences instead of glFinish (empty = off)
+std::vector<int> pipelineDepths;
+
+// Streaming mode: upload a new NV12 frame every iteration through a PBO ring
+bool streamingMode = false;
+int pboRingSize = 3;
+
+// CPU reference converter: run it next to the GPU path, or instead of it
+bool cpuReference = false;
+bool cpuOnly = false;
+int cpuThreads = 0;  // 0 = hardware concurrency
+CpuSimdLevel cpuSimdLevel = DetectCpuSimdLevel();
+
+// On-disk program binary cache (disabled unless a directory is given)
+std::string shaderCacheDir;
+bool shaderCacheBench = false;
+bool shaderCachePrune = false;  // delete other drivers' entries on open
+ProgramCache programCache;
+
+// Compile/link benchmark: number of programs to build (0 = off)
+int compileBenchPrograms = 0;
+
+// Shader variant used for the main run, and whether to benchmark the full matrix
+ShaderVariant activeVariant = BuildShaderVariantMatrix().front();
+bool runVariantMatrix = false;
+
+// Accuracy check against the CPU reference: max allowed per-channel error.
+// Texture units round bilinear weights to 1/256 of a texel; on content whose
+// chroma swings fully between neighbouring texels that costs up to 3 code
+// values against the exact-weight reference, whatever the content source.
+int accuracyTolerance = 3;
+
+// P010 pairs are verified against a reference built from the 16-bit samples,
+// which leaves only output rounding; a driver that stores GL_R16_EXT with 8
+// bits loses the low bits FillInputTestPattern sets and is off by 2 on
+// gradient or noise content.
+const int p010Tolerance = 1;
+bool accuracyFailed = false;
+
+// Readback benchmark: blocking glReadPixels vs a ring of pixel-pack PBOs
+bool readbackMode = false;
+int readbackRingSize = 3;
+
+// Converted image (format from the extension, empty = none) and the optional
+// Y4M/raw dump of every async readback frame, both written off the benchmark thread
+std::string outputPath = "output_test.bmp";
+std::string dumpFramesPath;
+ImageFileFormat outputFormat = ImageFileFormat::BMP;
+ImageFileFormat dumpFramesFormat = ImageFileFormat::Y4M;
+ImageWriter imageWriter;
+
+// Chrome trace JSON of per-stage CPU and GPU spans (empty = tracing off)
+std::string tracePath;
+
+// Frame-sized host buffers, allocated once per tag and reused by every test
+HostArena hostArena;
+bool hugePages = false;
+
+// Input/output format pairs to benchmark next to the main NV12 -> RGBA run (empty = off)
+std::vector<FormatPair> formatPairs;
+
+// Chroma sampling strategies to benchmark next to the main run (empty = off)
+std::vector<ChromaSampling> samplingStrategies;
+
+// Compute-shader path: workgroup sizes x output pixels per invocation to sweep
+bool computeMode = false;
+std::vector<std::pair<int, int>> computeWorkgroups = { { 8, 8 }, { 16, 8 }, { 16, 16 }, { 32, 8 }, { 32, 32 }, { 64, 1 } };
+std::vector<std::pair<int, int>> computePixelBlocks = { { 1, 1 }, { 2, 1 }, { 2, 2 }, { 4, 2 } };
+
+// Multi-pixel fragment path: 2x2 pixels per fragment at quarter resolution, then resolve
+bool multiPixelMode = false;
+
+// Structured results: every timing series plus environment metadata, written as
+// JSON/CSV and optionally compared against a baseline file
+ResultsReport results;
+std::string resultsJsonPath;
+std::string resultsCsvPath;
+std::string baselinePath;
+std::string comparePath;  // --compare-files: saved run to check instead of running
+RegressionOptions regressionOptions;
+
+// Input file (raw .nv12/.yuv or .y4m, memory-mapped) replacing the synthetic test pattern
+std::string inputPath;
+TestPattern testPattern = TestPattern::Gradient;
+YuvFileReader inputReader;
+
+// Resolution sweep: frame sizes to benchmark in one process (empty = off)
+struct FrameSize {
+    int width;
+    int height;
+};
+std::vector<FrameSize> sweepSizes;
+const std::vector<FrameSize> defaultSweepSizes = {
+    { 854, 480 }, { 1280, 720 }, { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 }, { 7680, 4320 },
+    // Odd and non-power-of-two sizes exercise the rounded-up chroma plane and unaligned rows
+    { 1366, 768 }, { 1023, 575 }, { 4095, 2161 },
+};
+
+// Batched conversion: batch sizes to sweep (empty = off) and the size of each stream
+std::vector<int> batchSizes;
+FrameSize batchStreamSize = { 352, 288 };  // CIF
+
+// Multi-context scaling: thread counts to run (empty = off), each thread with its
+// own EGL context and stream, sharing the main program or building its own
+std::vector<int> threadCounts;
+bool threadSharedProgram = true;
+bool threadSeparatePrograms = true;
+
+// Parse "WxH" into a frame size
+bool parseFrameSize(const char* text, FrameSize& size) {
+    int w = 0, h = 0;
+    char x = 0;
+    if (sscanf(text, "%d%c%d", &w, &x, &h) != 3 || (x != 'x' && x != 'X') || w <= 0 || h <= 0) {
+        std::cerr << "Invalid size '" << text << "', expected WxH" << std::endl;
+        return false;
+    }
+    size.width = w;
+    size.height = h;
+    return true;
+}
+
+// Parse a comma-separated "WxH,WxH,..." list
+bool parseSizeList(const std::string& list, std::vector<FrameSize>& sizes) {
+    sizes.clear();
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        FrameSize size;
+        if (!parseFrameSize(list.substr(start, end - start).c_str(), size)) {
+            return false;
+        }
+        sizes.push_back(size);
+        start = end + 1;
+    }
+    return true;
+}
+
+// Parse a comma-separated list of positive integers
+bool parseIntList(const std::string& list, std::vector<int>& values) {
+    values.clear();
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        int value = std::atoi(list.substr(start, end - start).c_str());
+        if (value <= 0) {
+            std::cerr << "Invalid list '" << list << "', expected positive integers" << std::endl;
+            return false;
+        }
+        values.push_back(value);
+        start = end + 1;
+    }
+    return true;
+}
+
 // 添加一些可能缺少的 EGL 常量定义
 #ifndef EGL_DEVICE_EXT
 #define EGL_DEVICE_EXT                     0x322C
@@ -72,11 +283,31 @@ bool verbose = false;
 #define EGL_PLATFORM_ANGLE_MAX_VERSION_MINOR_ANGLE 0x3205
 #endif
 
+// Headless (surfaceless / configless) constants
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+#ifndef EGL_NO_CONFIG_KHR
+#define EGL_NO_CONFIG_KHR ((EGLConfig)0)
+#endif
+
+// GL_EXT_texture_norm16 formats for P010 input
+#ifndef GL_R16_EXT
+#define GL_R16_EXT 0x822A
+#endif
+
+#ifndef GL_RG16_EXT
+#define GL_RG16_EXT 0x822C
+#endif
+
 // GPU related structures and variables
 struct GPUInfo {
     EGLDeviceEXT device;
     std::string name;
     std::string vendor;
+    std::string drmNode;    // EGL device backend only
+    bool software = false;  // EGL device backend only: Mesa software rasterizer
 };
 
 std::vector<GPUInfo> gpuList;
@@ -84,35 +315,48 @@ std::vector<GPUInfo> gpuList;
 // Function declarations
 void queryGPUAdapters();
 
-// Performance test parameters
-const int TEST_ITERATIONS = 100;
-const int WIDTH = 3840;  // 4K
-const int HEIGHT = 2160;
+// Performance test parameters (--iterations, --size, --sweep)
+int testIterations = 100;
+int frameWidth = 3840;  // 4K
+int frameHeight = 2160;
 
-// OpenGL related variables
-GLuint shaderProgram;
-GLuint VBO, VAO, EBO;
-GLuint yTexture, uvTexture;
+// EGL display shared by every context, and the config contexts are created with
 EGLDisplay display;
-EGLSurface surface;
-EGLContext context;
-GLuint fbo;
-GLuint outputTexture;
+EGLConfig eglConfig;
+
+// GL state of the main thread: context, program, quad, NV12 textures and output FBO.
+// Benchmarks that use other programs or targets swap its members and restore them.
+ConversionWorker mainWorker;
 
 // Performance test results
 struct PerfResult {
-    double avgTime;
-    double minTime;
-    double maxTime;
+    std::vector<double> cpuSamples;  // raw per-iteration wall-clock times (ms)
+    PerfStats cpu;
+
+    // GPU-side time from timer queries (only valid if hasGpuTime)
+    bool hasGpuTime = false;
+    std::vector<double> gpuSamples;
+    PerfStats gpu;
+    int gpuDisjointFrames = 0;
 };
 
-// Initialize EGL
-bool initEGL(HWND window, int gpuIndex = 0) {
-    if (verbose) {
-        std::cout << "\n=== EGL Initialization Start ===" << std::endl;
-        std::cout << "Requested GPU Index: " << gpuIndex << std::endl;
-    }
+// Summarize a timing series and add it to the structured results under name,
+// tagged with the current frame size and shader variant
+PerfStats recordStats(const std::string& name, const std::vector<double>& samples) {
+    ResultEntry entry;
+    entry.name = name;
+    entry.variant = activeVariant.name;
+    entry.width = frameWidth;
+    entry.height = frameHeight;
+    entry.samples = samples;
+    entry.stats = computeStats(samples);
+    results.entries.push_back(entry);
+    return entry.stats;
+}
 
+// Get the EGL display for the requested GPU
+EGLDisplay getEGLDisplay(int gpuIndex) {
+#ifdef _WIN32
     display = EGL_NO_DISPLAY;
     
     // 使用 EGLint 而不是 EGLAttrib
@@ -240,6 +484,38 @@ bool initEGL(HWND window, int gpuIndex = 0) {
         }
     }
 
+#else
+    display = EGL_NO_DISPLAY;
+
+    // An enumerated EGL device is opened through EGL_EXT_platform_device. No
+    // fallback: another display could run on a different GPU than selected.
+    if (gpuIndex >= 0 && gpuIndex < static_cast<int>(gpuList.size()) && gpuList[gpuIndex].device != EGL_NO_DEVICE_EXT) {
+        display = GetEglDeviceDisplay(gpuList[gpuIndex].device);
+        if (display == EGL_NO_DISPLAY) {
+            std::cerr << "Failed to get the EGL device display for GPU " << gpuIndex << " ("
+                      << gpuList[gpuIndex].name << ")" << std::endl;
+            return EGL_NO_DISPLAY;
+        }
+        if (verbose) {
+            std::cout << "Device platform display for " << gpuList[gpuIndex].name << ": OK" << std::endl;
+        }
+        return display;
+    }
+
+    // Otherwise prefer the Mesa surfaceless platform: it needs no X11/Wayland server
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (display == EGL_NO_DISPLAY && eglGetPlatformDisplayEXT &&
+        hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (verbose) {
+            std::cout << "Surfaceless platform display: "
+                      << (display != EGL_NO_DISPLAY ? "OK" : "failed") << std::endl;
+        }
+    }
+#endif
+
     // 如果失败，回退到默认方式
     if (display == EGL_NO_DISPLAY) {
         if (verbose) {
@@ -247,7 +523,14 @@ bool initEGL(HWND window, int gpuIndex = 0) {
         }
         display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
     }
-    
+
+    return display;
+}
+
+// Initialize the display and pick a config for the given surface type.
+// Returns EGL_NO_CONFIG_KHR when only a configless context is possible.
+bool initDisplayAndConfig(int gpuIndex, EGLint surfaceType, EGLConfig* config) {
+    display = getEGLDisplay(gpuIndex);
     if (display == EGL_NO_DISPLAY) {
         std::cerr << "Failed to get EGL display" << std::endl;
         return false;
@@ -269,8 +552,10 @@ bool initEGL(HWND window, int gpuIndex = 0) {
         std::cout << "EGL Extensions: " << (extensions ? extensions : "None") << std::endl;
     }
 
+    eglBindAPI(EGL_OPENGL_ES_API);
+
     const EGLint configAttribs[] = {
-        EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+        EGL_SURFACE_TYPE, surfaceType,
         EGL_RED_SIZE, 8,
         EGL_GREEN_SIZE, 8,
         EGL_BLUE_SIZE, 8,
@@ -279,31 +564,64 @@ bool initEGL(HWND window, int gpuIndex = 0) {
         EGL_NONE
     };
 
-    EGLConfig config;
-    EGLint numConfigs;
-    if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs)) {
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttribs, config, 1, &numConfigs)) {
         std::cerr << "Failed to choose EGL config" << std::endl;
         return false;
     }
 
-    const EGLint contextAttribs[] = {
-        EGL_CONTEXT_CLIENT_VERSION, 3,
-        EGL_NONE
-    };
+    if (numConfigs == 0) {
+        // The surfaceless platform exposes no configs; fall back to a configless context
+        const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (surfaceType == EGL_PBUFFER_BIT && hasExtension(extensions, "EGL_KHR_no_config_context")) {
+            *config = EGL_NO_CONFIG_KHR;
+            if (verbose) {
+                std::cout << "No matching EGL config, using EGL_KHR_no_config_context" << std::endl;
+            }
+        } else {
+            std::cerr << "No matching EGL config" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
 
-    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
-    if (context == EGL_NO_CONTEXT) {
+bool createContext(EGLConfig config) {
+    mainWorker.display = display;
+    mainWorker.context = CreateES3Context(display, config, EGL_NO_CONTEXT);
+    if (mainWorker.context == EGL_NO_CONTEXT) {
         std::cerr << "Failed to create EGL context" << std::endl;
         return false;
     }
+    eglConfig = config;
+    return true;
+}
+
+#ifdef _WIN32
+// Initialize EGL
+bool initEGL(HWND window, int gpuIndex = 0) {
+    if (verbose) {
+        std::cout << "\n=== EGL Initialization Start ===" << std::endl;
+        std::cout << "Requested GPU Index: " << gpuIndex << std::endl;
+    }
+
+    EGLConfig config;
+    if (!initDisplayAndConfig(gpuIndex, EGL_WINDOW_BIT, &config)) {
+        return false;
+    }
+
+    if (!createContext(config)) {
+        return false;
+    }
 
-    surface = eglCreateWindowSurface(display, config, window, nullptr);
-    if (surface == EGL_NO_SURFACE) {
+    mainWorker.surface = eglCreateWindowSurface(display, config, window, nullptr);
+    if (mainWorker.surface == EGL_NO_SURFACE) {
         std::cerr << "Failed to create EGL surface" << std::endl;
         return false;
     }
 
-    if (!eglMakeCurrent(display, surface, surface, context)) {
+    if (!eglMakeCurrent(display, mainWorker.surface, mainWorker.surface, mainWorker.context)) {
         std::cerr << "Failed to make EGL context current" << std::endl;
         return false;
     }
@@ -314,12 +632,64 @@ bool initEGL(HWND window, int gpuIndex = 0) {
 
     return true;
 }
+#endif
 
-// Initialize shaders
-bool initShaders() {
+// Initialize EGL without a window. All rendering goes to the offscreen FBO, so the
+// context is made current with EGL_KHR_surfaceless_context, or on a 1x1 pbuffer.
+bool initEGLHeadless(int gpuIndex = 0) {
+    if (verbose) {
+        std::cout << "\n=== EGL Headless Initialization Start ===" << std::endl;
+        std::cout << "Requested GPU Index: " << gpuIndex << std::endl;
+    }
+
+    EGLConfig config;
+    if (!initDisplayAndConfig(gpuIndex, EGL_PBUFFER_BIT, &config)) {
+        return false;
+    }
+
+    if (!createContext(config)) {
+        return false;
+    }
+
+    mainWorker.surface = EGL_NO_SURFACE;
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (!hasExtension(extensions, "EGL_KHR_surfaceless_context")) {
+        if (config == EGL_NO_CONFIG_KHR) {
+            std::cerr << "Neither surfaceless context nor pbuffer config available" << std::endl;
+            return false;
+        }
+        const EGLint pbufferAttribs[] = {
+            EGL_WIDTH, 1,
+            EGL_HEIGHT, 1,
+            EGL_NONE
+        };
+        mainWorker.surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (mainWorker.surface == EGL_NO_SURFACE) {
+            std::cerr << "Failed to create EGL pbuffer surface" << std::endl;
+            return false;
+        }
+    }
+
+    if (!eglMakeCurrent(display, mainWorker.surface, mainWorker.surface, mainWorker.context)) {
+        std::cerr << "Failed to make EGL context current" << std::endl;
+        return false;
+    }
+
+    if (verbose) {
+        std::cout << "Headless surface: " << (mainWorker.surface == EGL_NO_SURFACE ? "surfaceless" : "pbuffer") << std::endl;
+        std::cout << "GL_RENDERER: " << glGetString(GL_RENDERER) << std::endl;
+        std::cout << "GL_VERSION: " << glGetString(GL_VERSION) << std::endl;
+        std::cout << "=== EGL Headless Initialization Complete ===\n" << std::endl;
+    }
+
+    return true;
+}
+
+// Compile and link a program from vertex and fragment sources. Returns 0 on failure.
+GLuint buildProgram(const char* vsSource, const char* fsSource) {
     // Compile vertex shader
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
+    glShaderSource(vertexShader, 1, &vsSource, nullptr);
     glCompileShader(vertexShader);
 
     // Check compilation errors
@@ -329,12 +699,13 @@ bool initShaders() {
         char infoLog[512];
         glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
         std::cerr << "Vertex shader compilation failed: " << infoLog << std::endl;
-        return false;
+        glDeleteShader(vertexShader);
+        return 0;
     }
 
     // Compile fragment shader
     GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
+    glShaderSource(fragmentShader, 1, &fsSource, nullptr);
     glCompileShader(fragmentShader);
 
     glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
@@ -342,274 +713,2720 @@ bool initShaders() {
         char infoLog[512];
         glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
         std::cerr << "Fragment shader compilation failed: " << infoLog << std::endl;
-        return false;
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
     }
 
     // Link shader program
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
 
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
         char infoLog[512];
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
         std::cerr << "Shader program linking failed: " << infoLog << std::endl;
-        return false;
+        glDeleteProgram(program);
+        return 0;
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return true;
+    return program;
 }
 
+// Replace the #version line of a GLSL source
+std::string withGlslVersion(const std::string& source, const char* version) {
+    size_t eol = source.find('\n');
+    if (source.compare(0, 8, "#version") != 0 || eol == std::string::npos) {
+        return source;
+    }
+    return std::string("#version ") + version + source.substr(eol);
+}
 
-void initFramebuffer() {
-    // Create and setup FBO
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-
-    // Create color attachment texture
-    glGenTextures(1, &outputTexture);
-    glBindTexture(GL_TEXTURE_2D, outputTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, WIDTH, HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);  // Use RGBA format
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);  // Use NEAREST filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    
-    // Attach texture to FBO
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outputTexture, 0);
+// Build the program for a shader variant, going through the program binary cache when enabled.
+// glslVersion (e.g. "310 es") recompiles both stages at that version.
+GLuint buildVariantProgram(const ShaderVariant& variant, const char* glslVersion = nullptr) {
+    std::string vsSource = vertexShaderSource;
+    std::string fsSource = InjectShaderDefines(fragmentShaderSource, variant.defines);
+    if (glslVersion) {
+        vsSource = withGlslVersion(vsSource, glslVersion);
+        fsSource = withGlslVersion(fsSource, glslVersion);
+    }
 
-    // Check if FBO is complete
-    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-    if (status != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "Framebuffer is not complete! Status: " << status << std::endl;
-    } else {
-        std::cout << "Framebuffer is complete!" << std::endl;
+    std::string key;
+    if (programCache.isEnabled()) {
+        key = programCache.makeKey(vsSource.c_str(), fsSource.c_str());
+        GLuint cached = programCache.load(key);
+        if (cached) return cached;
     }
 
-    // Reset binding
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLuint program = buildProgram(vsSource.c_str(), fsSource.c_str());
+    if (programCache.isEnabled()) {
+        programCache.store(key, program);
+    }
+    return program;
 }
 
-// Initialize vertex data and textures
-void initGeometryAndTextures() {
-    float vertices[] = {
-        // Position          // Texture coordinates
-        -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
-         1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
-         1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
-        -1.0f,  1.0f, 0.0f, 0.0f, 1.0f
-    };
+// Initialize shaders
+bool initShaders() {
+    int hitsBefore = programCache.hits();
+    auto start = std::chrono::high_resolution_clock::now();
+    mainWorker.program = buildVariantProgram(activeVariant);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "Shader program build: " << std::chrono::duration<double, std::milli>(end - start).count() << " ms";
+    if (programCache.isEnabled()) {
+        std::cout << (programCache.hits() > hitsBefore ? " (warm, from program cache)" : " (cold, compiled from source)");
+    }
+    std::cout << std::endl;
+    return mainWorker.program != 0;
+}
 
-    unsigned int indices[] = {
-        0, 1, 2,
-        0, 2, 3
+// Build every shader variant with an empty cache (cold) and again from the
+// cache (warm) to show the startup time the program binary cache saves. Runs
+// against a scratch cache in the temp directory so the --shader-cache entries
+// are neither used nor wiped.
+void runProgramCacheBenchmark() {
+    std::vector<ShaderVariant> variants = BuildShaderVariantMatrix();
+    using Clock = std::chrono::high_resolution_clock;
+
+    const std::filesystem::path benchDirectory = std::filesystem::temp_directory_path() /
+        ("shader_perf_cache_bench_" + std::to_string(Clock::now().time_since_epoch().count()));
+    ProgramCache benchCache;
+    if (!benchCache.open(benchDirectory.string())) {
+        return;
+    }
+    std::swap(programCache, benchCache);
+
+    auto buildAll = [&](int& hits) {
+        int hitsBefore = programCache.hits();
+        auto start = Clock::now();
+        for (const ShaderVariant& variant : variants) {
+            GLuint program = buildVariantProgram(variant);
+            // Force the driver to finish any deferred compilation work
+            GLint linked = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+            glDeleteProgram(program);
+        }
+        glFinish();
+        hits = programCache.hits() - hitsBefore;
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
     };
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // 删除这部分，因为我们后面会重新创建纹理
-    /*
-    std::vector<unsigned char> yData(WIDTH * HEIGHT, 128);
-    std::vector<unsigned char> uvData(WIDTH * HEIGHT / 2, 128);
+    int coldHits = 0, warmHits = 0;
+    double coldMs = buildAll(coldHits);
+    double warmMs = buildAll(warmHits);
+
+    std::swap(programCache, benchCache);
+    std::error_code ec;
+    std::filesystem::remove_all(benchDirectory, ec);
+
+    std::cout << "\nProgram Cache Startup (" << variants.size() << " programs):" << std::endl;
+    std::cout << "  Cold (compile + link): " << coldMs << " ms total, "
+              << coldMs / variants.size() << " ms/program, " << coldHits << " cache hits" << std::endl;
+    std::cout << "  Warm (glProgramBinary): " << warmMs << " ms total, "
+              << warmMs / variants.size() << " ms/program, " << warmHits << " cache hits" << std::endl;
+    if (warmMs > 0) {
+        std::cout << "  Speedup: " << coldMs / warmMs << "x" << std::endl;
+    }
+}
 
-    glGenTextures(1, &yTexture);
-    glBindTexture(GL_TEXTURE_2D, yTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, WIDTH, HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, yData.data());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glGenTextures(1, &uvTexture);
-    glBindTexture(GL_TEXTURE_2D, uvTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, WIDTH/2, HEIGHT/2, 0, GL_RG, GL_UNSIGNED_BYTE, uvData.data());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    */
+// Bind program, sampler units and the output FBO for the conversion draws
+void beginConversionPass() {
+    SetConversionSamplerUnits(mainWorker.program);
+    BeginWorkerPass(mainWorker);
+}
 
-    initFramebuffer();
+// Issue the draw for one converted frame
+void drawConversionFrame(GLuint yTex, GLuint uvTex) {
+    DrawWorkerFrame(mainWorker, yTex, uvTex);
 }
 
-// Run performance test
-PerfResult runPerfTest() {
+// Run performance test, recorded in the results as name and name + "/gpu"
+PerfResult runPerfTest(const std::string& name) {
     std::vector<double> times;
-    times.reserve(TEST_ITERATIONS);
+    times.reserve(testIterations);
 
-    glUseProgram(shaderProgram);
-    
-    // Set texture units
-    glUniform1i(glGetUniformLocation(shaderProgram, "yTexture"), 0);
-    glUniform1i(glGetUniformLocation(shaderProgram, "uvTexture"), 1);
+    GpuTimer gpuTimer;
+    if (useGpuTimer) {
+        gpuTimer.init();
+    }
+    GpuTraceTimer gpuTrace;
+    gpuTrace.init();
 
-    // Bind FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glViewport(0, 0, WIDTH, HEIGHT);
+    beginConversionPass();
 
     // 添加这行
     glClear(GL_COLOR_BUFFER_BIT);
 
-    for (int i = 0; i < TEST_ITERATIONS; i++) {
+    for (int i = 0; i < testIterations; i++) {
+        TraceScope frameSpan("frame", "convert", i);
         auto start = std::chrono::high_resolution_clock::now();
 
-        // Bind textures
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, yTexture);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, uvTexture);
+        {
+            TraceScope span("draw", "convert", i);
+            gpuTimer.begin();
+            gpuTrace.begin("convert", i);
+            drawConversionFrame(mainWorker.yTexture, mainWorker.uvTexture);
+            gpuTrace.end();
+            gpuTimer.end();
+        }
 
-        // Render
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        
         // Sync GPU
-        glFinish();
+        {
+            TraceScope span("glFinish", "sync", i);
+            glFinish();
+        }
 
         auto end = std::chrono::high_resolution_clock::now();
         double time = std::chrono::duration<double, std::milli>(end - start).count();
         times.push_back(time);
+
+        // Read back queries issued in earlier frames without blocking
+        gpuTimer.collect(false);
+        gpuTrace.collect(false);
+        PollGpuDisjoint();
     }
+    gpuTrace.collect(true);
 
     // Reset FBO binding
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // Calculate statistics
-    double avgTime = 0;
-    for (double time : times) {
-        avgTime += time;
+    PerfResult result;
+    result.cpuSamples = times;
+    result.cpu = recordStats(name, times);
+
+    gpuTimer.collect(true);
+    if (!gpuTimer.samples().empty()) {
+        result.hasGpuTime = true;
+        result.gpuSamples = gpuTimer.samples();
+        result.gpu = recordStats(name + "/gpu", result.gpuSamples);
     }
-    avgTime /= TEST_ITERATIONS;
-
-    double minTime = *std::min_element(times.begin(), times.end());
-    double maxTime = *std::max_element(times.begin(), times.end());
+    result.gpuDisjointFrames = gpuTimer.disjointCount();
 
-    return {avgTime, minTime, maxTime};
+    return result;
 }
 
-// Cleanup resources
-void cleanup() {
-    glDeleteFramebuffers(1, &fbo);
-    glDeleteTextures(1, &outputTexture);
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteTextures(1, &yTexture);
-    glDeleteTextures(1, &uvTexture);
-    glDeleteProgram(shaderProgram);
-
-    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
-    eglDestroyContext(display, context);
-    eglDestroySurface(display, surface);
-    eglTerminate(display);
-}
+// Pipelined throughput test results
+struct PipelineResult {
+    int framesInFlight;
+    double fps;          // sustained throughput over the steady-state frames
+    PerfStats latency;   // submit -> fence signaled, per frame (ms)
+    bool hasGpuTime = false;
+    PerfStats gpu;
+};
 
-// Window procedure function
-LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
-    switch (uMsg) {
-        case WM_CLOSE:
-            PostQuitMessage(0);
-            return 0;
+// Run the conversion with up to framesInFlight frames queued on the GPU.
+// Each frame is followed by a fence instead of glFinish; the CPU only blocks
+// when the ring is full, waiting for the oldest frame.
+PipelineResult runPipelinedTest(int framesInFlight) {
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct InFlightFrame {
+        GLsync fence = nullptr;
+        Clock::time_point submitTime;
+    };
+    std::vector<InFlightFrame> ring(framesInFlight);
+    std::vector<double> latencies;
+    std::vector<Clock::time_point> completionTimes;
+    latencies.reserve(testIterations);
+    completionTimes.reserve(testIterations);
+
+    GpuTimer gpuTimer(framesInFlight + 2);
+    if (useGpuTimer) {
+        gpuTimer.init();
     }
-    return DefWindowProc(hwnd, uMsg, wParam, lParam);
-}
 
-void queryGPUAdapters() {
-    // 尝试用 DXGI 来枚举 GPU
-    IDXGIFactory1* factory = nullptr;
-    std::vector<IDXGIAdapter1*> adapters;
-    
-    HRESULT hr = CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&factory);
-    if (SUCCEEDED(hr)) {
-        IDXGIAdapter1* adapter = nullptr;
-        for (UINT i = 0; factory->EnumAdapters1(i, &adapter) != DXGI_ERROR_NOT_FOUND; ++i) {
-            DXGI_ADAPTER_DESC1 desc;
-            adapter->GetDesc1(&desc);
-            
-            GPUInfo info;
-            info.device = EGL_NO_DEVICE_EXT;  // 我们不使用 EGL device
-            
-            // 将 WCHAR 转换为 string
-            char name[128];
-            wcstombs(name, desc.Description, sizeof(name));
-            info.name = name;
-            
-            // 使用 VendorID 来确定厂商
-            switch(desc.VendorId) {
-                case 0x10DE: info.vendor = "NVIDIA"; break;
-                case 0x1002: info.vendor = "AMD"; break;
-                case 0x8086: info.vendor = "Intel"; break;
-                default: info.vendor = "Unknown"; break;
-            }
-            
-            gpuList.push_back(info);
-            std::cout << "GPU " << gpuList.size()-1 << ": " << info.name 
-                     << " (" << info.vendor << ")" << std::endl;
-            
-            adapter->Release();
+    // Retire the frame in slot if its fence has signaled (or wait for it)
+    auto retire = [&](InFlightFrame& frame, bool wait) {
+        if (!frame.fence) return true;
+        GLuint64 timeout = wait ? 1000000000ull : 0;  // 1 s per wait, in ns
+        GLenum status;
+        do {
+            status = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        } while (wait && status == GL_TIMEOUT_EXPIRED);
+        if (status == GL_WAIT_FAILED) {
+            std::cerr << "glClientWaitSync failed: 0x" << std::hex << glGetError() << std::dec << std::endl;
+        } else if (status == GL_TIMEOUT_EXPIRED) {
+            return false;
         }
-        factory->Release();
+
+        auto now = Clock::now();
+        latencies.push_back(std::chrono::duration<double, std::milli>(now - frame.submitTime).count());
+        completionTimes.push_back(now);
+        glDeleteSync(frame.fence);
+        frame.fence = nullptr;
+        return true;
+    };
+
+    beginConversionPass();
+    glClear(GL_COLOR_BUFFER_BIT);
+    glFinish();
+
+    for (int i = 0; i < testIterations; i++) {
+        int slot = i % framesInFlight;
+
+        // Ring full: block on the oldest frame before reusing its slot
+        retire(ring[slot], true);
+
+        ring[slot].submitTime = Clock::now();
+        gpuTimer.begin();
+        drawConversionFrame(mainWorker.yTexture, mainWorker.uvTexture);
+        gpuTimer.end();
+        ring[slot].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        // Opportunistically retire older frames that already finished, in order,
+        // so their completion time is observed close to when it happened
+        for (int k = 1; k < framesInFlight; k++) {
+            int older = (slot + k) % framesInFlight;
+            if (!retire(ring[older], false)) break;
+        }
+        gpuTimer.collect(false);
+        PollGpuDisjoint();
     }
 
-    // 如果没有找到任何设备，添加一个默认设备
-    if (gpuList.empty()) {
-        GPUInfo defaultGPU;
-        defaultGPU.device = EGL_NO_DEVICE_EXT;
-        defaultGPU.name = "Default GPU";
-        defaultGPU.vendor = "Default Vendor";
-        gpuList.push_back(defaultGPU);
-        std::cout << "Using default GPU" << std::endl;
+    // Drain the pipeline
+    for (int k = 1; k <= framesInFlight; k++) {
+        retire(ring[(testIterations + k - 1) % framesInFlight], true);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    PipelineResult result;
+    result.framesInFlight = framesInFlight;
+    const std::string resultName = "pipeline/depth" + std::to_string(framesInFlight);
+    result.latency = recordStats(resultName + "/latency", latencies);
+
+    // Throughput from completion timestamps, skipping the warm-up transient
+    int first = std::min(result.latency.warmupSamples, static_cast<int>(completionTimes.size()) - 2);
+    first = std::max(first, 0);
+    double span = std::chrono::duration<double>(completionTimes.back() - completionTimes[first]).count();
+    int frames = static_cast<int>(completionTimes.size()) - 1 - first;
+    result.fps = span > 0 ? frames / span : 0;
+
+    gpuTimer.collect(true);
+    if (!gpuTimer.samples().empty()) {
+        result.hasGpuTime = true;
+        result.gpu = recordStats(resultName + "/gpu", gpuTimer.samples());
     }
+
+    return result;
 }
 
-int main(int argc, char* argv[]) {
-    // 在 main 函数开头添加
-    SetEnvironmentVariable("ANGLE_DEFAULT_PLATFORM", "d3d11");
-    SetEnvironmentVariable("ANGLE_D3D11_FORCE_DISCRETE_GPU", "1");
-    SetEnvironmentVariable("ANGLE_PLATFORM_ANGLE_DEVICE_TYPE", "hardware");
-    SetEnvironmentVariable("ANGLE_DEBUG_DISPLAY", "1");
-    SetEnvironmentVariable("ANGLE_DEBUG_LAYERS", "1");
-    
-    int selectedGPU = 0;
+// Streaming upload test results
+struct StreamingResult {
+    int ringSize;
+    PerfStats upload;        // CPU: map + copy + unmap + glTexSubImage2D issue
+    PerfStats frame;         // CPU: full iteration including any fence wait
+    bool hasGpuTime = false;
+    PerfStats gpuUpload;     // GPU: PBO -> texture copy
+    PerfStats gpuConvert;    // GPU: conversion draw
+    double fps;              // overlapped end-to-end throughput
+};
 
-    // 处理命令行参数
-    for (int i = 1; i < argc; i++) {
-        std::string arg = argv[i];
-        if (arg == "--gpu" && i + 1 < argc) {
-            selectedGPU = std::atoi(argv[i + 1]);
-            i++;
-        }
-        else if (arg == "--list-gpus") {
-            queryGPUAdapters();
-            return 0;
-        }
+// Create the NV12 textures from a host frame, plus the output FBO, at the current frame size
+void initFrameResources(const uint8_t* nv12) {
+    if (InitWorkerFrame(mainWorker, nv12, frameWidth, frameHeight)) {
+        std::cout << "Framebuffer is complete!" << std::endl;
+    }
+}
+
+// Delete everything created by initFrameResources
+void releaseFrameResources() {
+    ReleaseWorkerFrame(mainWorker);
+}
+
+// Frame frameIndex of the selected test pattern, generated on the caller's
+// long-lived CPU thread pool
+void generatePatternFrame(uint8_t* nv12, int frameIndex, ThreadPool& pool) {
+    TraceScope span("generate_pattern", "input", frameIndex);
+    GenerateNV12Pattern(testPattern, nv12, nv12 + static_cast<size_t>(frameWidth) * frameHeight, frameWidth,
+                        frameHeight, frameIndex, &pool);
+}
+
+// First input frame as NV12: frame 0 of the --input file, or the test pattern
+void loadInputFrame(uint8_t* nv12, ThreadPool& pool) {
+    if (inputReader.isOpen()) {
+        TraceScope span("load_input", "input", 0);
+        InputToNV12(inputReader.format(), inputReader.frame(0), nv12, frameWidth, frameHeight);
+        return;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    generatePatternFrame(nv12, 0, pool);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Test pattern " << TestPatternName(testPattern) << " generated in "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+}
+
+// Create an NV12 texture pair with the same layout as yTexture/uvTexture
+void createNV12Textures(GLuint& yTex, GLuint& uvTex) {
+    CreateNV12Textures(frameWidth, frameHeight, nullptr, false, GL_LINEAR, yTex, uvTex);
+}
+
+// Upload a fresh NV12 frame every iteration through a ring of pixel-unpack PBOs.
+// Each ring slot owns a PBO and its own Y/UV textures, so staging frame N+1 on
+// the CPU overlaps the GPU copy and conversion of frame N. A slot is only
+// rewritten after the fence placed behind its conversion draw has signaled.
+StreamingResult runStreamingTest(const std::function<const uint8_t*()>& nextFrame, InputFormat sourceFormat,
+                                 int ringSize) {
+    using Clock = std::chrono::high_resolution_clock;
+    const size_t frameSize = NV12FrameSize(frameWidth, frameHeight);
+    const size_t ySize = static_cast<size_t>(frameWidth) * frameHeight;
+
+    struct StreamSlot {
+        GLuint pbo = 0;
+        GLuint yTex = 0;
+        GLuint uvTex = 0;
+        GLsync fence = nullptr;
+    };
+    std::vector<StreamSlot> ring(ringSize);
+    for (StreamSlot& slot : ring) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, frameSize, nullptr, GL_STREAM_DRAW);
+        createNV12Textures(slot.yTex, slot.uvTex);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    GpuTimer uploadTimer(ringSize + 2), convertTimer(ringSize + 2);
+    if (useGpuTimer) {
+        uploadTimer.init();
+        convertTimer.init();
+    }
+    GpuTraceTimer gpuTrace(2 * (ringSize + 2));
+    gpuTrace.init();
+
+    std::vector<double> uploadTimes, frameTimes;
+    uploadTimes.reserve(testIterations);
+    frameTimes.reserve(testIterations);
+
+    beginConversionPass();
+    glFinish();
+
+    auto runStart = Clock::now();
+    for (int i = 0; i < testIterations; i++) {
+        StreamSlot& slot = ring[i % ringSize];
+        auto frameStart = Clock::now();
+
+        // The slot's previous upload and conversion must be done before reuse
+        if (slot.fence) {
+            TraceScope span("wait_slot", "sync", i);
+            while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED) {
+            }
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+
+        auto uploadStart = Clock::now();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+        void* staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, frameSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (!staging) {
+            std::cerr << "glMapBufferRange failed: 0x" << std::hex << glGetError() << std::dec << std::endl;
+            break;
+        }
+        // The only host copy: source frame (e.g. the mapped input file) into the
+        // PBO, interleaving U and V on the way for I420 sources
+        {
+            TraceScope span("stage", "upload", i);
+            InputToNV12(sourceFormat, nextFrame(), static_cast<uint8_t*>(staging), frameWidth, frameHeight);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        {
+            TraceScope span("upload", "upload", i);
+            uploadTimer.begin();
+            gpuTrace.begin("upload", i);
+            glBindTexture(GL_TEXTURE_2D, slot.yTex);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frameWidth, frameHeight, GL_RED, GL_UNSIGNED_BYTE, (void*)0);
+            glBindTexture(GL_TEXTURE_2D, slot.uvTex);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, NV12ChromaWidth(frameWidth), NV12ChromaHeight(frameHeight),
+                            GL_RG, GL_UNSIGNED_BYTE, (void*)ySize);
+            gpuTrace.end();
+            uploadTimer.end();
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        auto uploadEnd = Clock::now();
+
+        {
+            TraceScope span("draw", "convert", i);
+            convertTimer.begin();
+            gpuTrace.begin("convert", i);
+            drawConversionFrame(slot.yTex, slot.uvTex);
+            gpuTrace.end();
+            convertTimer.end();
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+        }
+
+        auto frameEnd = Clock::now();
+        uploadTimes.push_back(std::chrono::duration<double, std::milli>(uploadEnd - uploadStart).count());
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+
+        uploadTimer.collect(false);
+        convertTimer.collect(false);
+        gpuTrace.collect(false);
+        PollGpuDisjoint();
+    }
+    glFinish();
+    gpuTrace.collect(true);
+    auto runEnd = Clock::now();
+
+    StreamingResult result;
+    result.ringSize = ringSize;
+    result.upload = recordStats("streaming/upload", uploadTimes);
+    result.frame = recordStats("streaming/frame", frameTimes);
+    double seconds = std::chrono::duration<double>(runEnd - runStart).count();
+    result.fps = seconds > 0 ? frameTimes.size() / seconds : 0;
+
+    uploadTimer.collect(true);
+    convertTimer.collect(true);
+    if (!uploadTimer.samples().empty() && !convertTimer.samples().empty()) {
+        result.hasGpuTime = true;
+        result.gpuUpload = recordStats("streaming/gpu_upload", uploadTimer.samples());
+        result.gpuConvert = recordStats("streaming/gpu_convert", convertTimer.samples());
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    for (StreamSlot& slot : ring) {
+        if (slot.fence) glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.pbo);
+        glDeleteTextures(1, &slot.yTex);
+        glDeleteTextures(1, &slot.uvTex);
+    }
+
+    return result;
+}
+
+// Readback benchmark results
+struct ReadbackResult {
+    int ringSize;
+    PerfStats syncRead;       // blocking glReadPixels into host memory
+    PerfStats asyncLatency;   // glReadPixels into PBO issued -> data copied out of the mapped PBO
+    PerfStats mapCopy;        // map + memcpy + unmap of a finished PBO
+    double syncFps;           // convert + blocking read, frames per second
+    double asyncFps;          // convert + PBO read with overlap, frames per second
+    double syncBandwidth;     // GB/s of the blocking read alone
+    double asyncBandwidth;    // GB/s sustained by the overlapped pipeline
+};
+
+// Benchmark the CPU reference converter on the same NV12 input
+PerfResult runCpuConversionTest(const uint8_t* nv12, uint8_t* rgba, ThreadPool& pool) {
+    const uint8_t* y_plane = nv12;
+    const uint8_t* uv_plane = nv12 + static_cast<size_t>(frameWidth) * frameHeight;
+    const YuvToRgbCoefficients& coeffs = activeVariant.coeffs;
+
+    std::vector<double> times;
+    times.reserve(testIterations);
+    for (int i = 0; i < testIterations; i++) {
+        TraceScope span("cpu_convert", "convert", i);
+        auto start = std::chrono::high_resolution_clock::now();
+        ConvertNV12ToRGBA(y_plane, uv_plane, rgba, frameWidth, frameHeight, coeffs, cpuSimdLevel, &pool);
+        auto end = std::chrono::high_resolution_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    PerfResult result;
+    result.cpuSamples = times;
+    result.cpu = recordStats("cpu_convert", times);
+    return result;
+}
+
+void printCpuConversionResult(const PerfResult& result, const ThreadPool& pool) {
+    std::cout << "\nCPU Reference Conversion (" << CpuSimdLevelName(cpuSimdLevel) << ", "
+              << pool.size() << " threads):" << std::endl;
+    printStats("CPU convert", result.cpu);
+    double mpix = static_cast<double>(frameWidth) * frameHeight / 1.0e6;
+    std::cout << "Throughput: " << (result.cpu.p50 > 0 ? mpix / (result.cpu.p50 / 1000.0) : 0)
+              << " Mpixel/s (P50)" << std::endl;
+}
+
+// Frame size, iteration count and host settings of this run
+void addRunMetadata() {
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    results.setMetadata("timestamp", timestamp);
+    results.setMetadata("resolution", std::to_string(frameWidth) + "x" + std::to_string(frameHeight));
+    results.setMetadata("iterations", std::to_string(testIterations));
+    results.setMetadata("variant", activeVariant.name);
+    results.setMetadata("input", inputPath.empty() ? "test_pattern" : inputPath);
+    results.setMetadata("pattern", inputPath.empty() ? TestPatternName(testPattern) : "none");
+    results.setMetadata("cpu_simd", CpuSimdLevelName(cpuSimdLevel));
+    results.setMetadata("cpu_threads", std::to_string(cpuThreads > 0 ? cpuThreads : static_cast<int>(std::thread::hardware_concurrency())));
+    AddBuildMetadata(results);
+}
+
+// GL/EGL identification of the current context
+void addDriverMetadata(const std::string& adapterName) {
+    auto glString = [](GLenum name) {
+        const char* value = reinterpret_cast<const char*>(glGetString(name));
+        return std::string(value ? value : "");
+    };
+    auto eglString = [](EGLDisplay dpy, EGLint name) {
+        const char* value = eglQueryString(dpy, name);
+        return std::string(value ? value : "");
+    };
+    // Client extensions are queried without a display; clear the error if unsupported
+    std::string clientExtensions = eglString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    eglGetError();
+
+    results.setMetadata("gpu_adapter", adapterName);
+    results.setMetadata("gl_vendor", glString(GL_VENDOR));
+    results.setMetadata("gl_renderer", glString(GL_RENDERER));
+    results.setMetadata("gl_version", glString(GL_VERSION));
+    results.setMetadata("glsl_version", glString(GL_SHADING_LANGUAGE_VERSION));
+    results.setMetadata("egl_vendor", eglString(display, EGL_VENDOR));
+    results.setMetadata("egl_version", eglString(display, EGL_VERSION));
+    results.setMetadata("egl_extensions", eglString(display, EGL_EXTENSIONS));
+    results.setMetadata("egl_client_extensions", clientExtensions);
+    results.setMetadata("gpu_timer", useGpuTimer ? "on" : "off");
+}
+
+// Queue the converted frame for --output; encoding runs on the image writer thread
+void writeOutputImage(const uint8_t* rgba) {
+    if (!outputPath.empty()) {
+        imageWriter.submit(outputPath, outputFormat, rgba, frameWidth, frameHeight);
+    }
+}
+
+// Wait for queued images and frame dumps and report what the writer did
+void finishImageOutput() {
+    bool ok = imageWriter.finish();
+    ImageWriterStats stats = imageWriter.stats();
+    if (stats.frames == 0) {
+        return;
+    }
+    std::cout << "Image output: " << stats.frames << " frame(s), " << stats.bytes / (1024.0 * 1024.0) << " MB, "
+              << stats.encodeMs << " ms on the writer thread, " << stats.stallMs << " ms waiting for a free buffer"
+              << (ok ? "" : " (WRITE FAILED)") << std::endl;
+}
+
+// Stop tracing and write the --trace file
+void finishTrace() {
+    if (!TraceEnabled()) {
+        return;
+    }
+    TraceStop();
+    if (TraceWriteChromeJson(tracePath)) {
+        std::cout << "Trace written to " << tracePath << " (" << TraceSpanCount() << " spans";
+        if (TraceDroppedCount() > 0) {
+            std::cout << ", oldest " << TraceDroppedCount() << " dropped";
+        }
+        std::cout << ")" << std::endl;
+    }
+}
+
+// Print the host arena and process memory for one configuration and record the
+// peaks as "<config>_arena_mb" / "<config>_peak_rss_mb" run metadata
+void reportHostMemory(const std::string& config) {
+    ProcessMemory memory = QueryProcessMemory();
+    char arenaMb[32], peakRssMb[32];
+    snprintf(arenaMb, sizeof(arenaMb), "%.1f", hostArena.peakBytes() / (1024.0 * 1024.0));
+    snprintf(peakRssMb, sizeof(peakRssMb), "%.1f", memory.peakResidentBytes / (1024.0 * 1024.0));
+    std::cout << "Host memory (" << config << "): arena peak " << arenaMb << " MB, "
+              << hostArena.allocationCount() << " allocation(s) so far; peak RSS " << peakRssMb << " MB" << std::endl;
+    results.setMetadata(config + "_arena_mb", arenaMb);
+    results.setMetadata(config + "_peak_rss_mb", peakRssMb);
+}
+
+// Write the --json/--csv files and check the run against the --compare baseline.
+// Returns false if a significant regression was found.
+bool finishResults() {
+    if (!resultsJsonPath.empty() && WriteResultsJson(resultsJsonPath.c_str(), results)) {
+        std::cout << "Results written to " << resultsJsonPath << std::endl;
+    }
+    if (!resultsCsvPath.empty() && WriteResultsCsv(resultsCsvPath.c_str(), results)) {
+        std::cout << "Results written to " << resultsCsvPath << std::endl;
+    }
+    if (baselinePath.empty()) {
+        return true;
+    }
+
+    ResultsReport baseline;
+    if (!LoadResultsJson(baselinePath.c_str(), baseline)) {
+        return false;
+    }
+    std::vector<RegressionRow> rows = CompareResults(baseline, results, regressionOptions);
+    return PrintRegressionReport(rows, regressionOptions) == 0;
+}
+
+// GPU-less run: convert on the CPU only and write the same output image
+int runCpuOnly() {
+    ThreadPool pool(cpuThreads);
+    uint8_t* nv12_data = hostArena.get("frame/nv12", NV12FrameSize(frameWidth, frameHeight));
+    loadInputFrame(nv12_data, pool);
+
+    uint8_t* rgba_data = hostArena.get("frame/rgba", static_cast<size_t>(frameWidth) * frameHeight * 4);
+    PerfResult result = runCpuConversionTest(nv12_data, rgba_data, pool);
+    printCpuConversionResult(result, pool);
+
+    writeOutputImage(rgba_data);
+    finishImageOutput();
+    finishTrace();
+    reportHostMemory("cpu_only");
+
+    return finishResults() ? 0 : 2;
+}
+
+// Compare a GPU result against the CPU reference conversion of the same input.
+// A failure is reported loudly and makes the process exit non-zero.
+bool verifyAgainstReference(const char* label, const uint8_t* rgba, const uint8_t* nv12,
+                            const YuvToRgbCoefficients& coeffs) {
+    uint8_t* reference = hostArena.get("verify/reference", static_cast<size_t>(frameWidth) * frameHeight * 4);
+    ThreadPool pool(cpuThreads);
+    ConvertNV12ToRGBA(nv12, nv12 + static_cast<size_t>(frameWidth) * frameHeight, reference,
+                      frameWidth, frameHeight, coeffs, DetectCpuSimdLevel(), &pool);
+
+    AccuracyReport report = CompareRGBA(rgba, reference, frameWidth, frameHeight, accuracyTolerance);
+    PrintAccuracyReport(label, report);
+    if (!report.passed) {
+        accuracyFailed = true;
+    }
+    return report.passed;
+}
+
+// Wait for a fence, retrying until it signals
+void waitFence(GLsync fence) {
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED) {
+    }
+}
+
+// Read the bound FBO into host memory through a pixel-pack PBO
+bool readbackToHost(uint8_t* dst) {
+    TraceScope span("readback", "readback");
+    const size_t frameBytes = static_cast<size_t>(frameWidth) * frameHeight * 4;
+    GLuint pbo;
+    glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, frameWidth, frameHeight, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    waitFence(fence);
+    glDeleteSync(fence);
+
+    void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT);
+    if (mapped) {
+        memcpy(dst, mapped, frameBytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteBuffers(1, &pbo);
+    return mapped != nullptr;
+}
+
+// Benchmark readback as its own stage. The synchronous pass reads each frame
+// with a blocking glReadPixels; the asynchronous pass reads into a ring of
+// pixel-pack PBOs and only maps a PBO ringSize-1 frames later, so converting
+// frame N+1 overlaps the download of frame N.
+ReadbackResult runReadbackTest(int ringSize) {
+    using Clock = std::chrono::high_resolution_clock;
+    const size_t frameBytes = static_cast<size_t>(frameWidth) * frameHeight * 4;
+    uint8_t* hostFrame = hostArena.get("readback/host", frameBytes);
+
+    ReadbackResult result;
+    result.ringSize = ringSize;
+
+    beginConversionPass();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glFinish();
+
+    // Synchronous baseline
+    std::vector<double> syncTimes;
+    syncTimes.reserve(testIterations);
+    auto syncStart = Clock::now();
+    for (int i = 0; i < testIterations; i++) {
+        drawConversionFrame(mainWorker.yTexture, mainWorker.uvTexture);
+        auto readStart = Clock::now();
+        {
+            TraceScope span("read_sync", "readback", i);
+            glReadPixels(0, 0, frameWidth, frameHeight, GL_RGBA, GL_UNSIGNED_BYTE, hostFrame);
+        }
+        auto readEnd = Clock::now();
+        syncTimes.push_back(std::chrono::duration<double, std::milli>(readEnd - readStart).count());
+    }
+    double syncSeconds = std::chrono::duration<double>(Clock::now() - syncStart).count();
+
+    // Asynchronous PBO ring
+    struct ReadbackSlot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        Clock::time_point issueTime;
+        int frame = -1;
+    };
+    std::vector<ReadbackSlot> ring(ringSize);
+    for (ReadbackSlot& slot : ring) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    }
+
+    std::vector<double> latencies, mapTimes;
+    latencies.reserve(testIterations);
+    mapTimes.reserve(testIterations);
+
+    GpuTraceTimer gpuTrace(2 * ringSize + 2);
+    gpuTrace.init();
+
+    auto retire = [&](ReadbackSlot& slot) {
+        TraceScope span("retire", "readback", slot.frame);
+        waitFence(slot.fence);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        auto mapStart = Clock::now();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT);
+        if (mapped && !dumpFramesPath.empty()) {
+            // Copy into a writer buffer instead; encoding happens on the writer thread
+            std::vector<uint8_t> frame = imageWriter.acquireBuffer(frameBytes);
+            memcpy(frame.data(), mapped, frameBytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            imageWriter.submit(dumpFramesPath, dumpFramesFormat, std::move(frame), frameWidth, frameHeight);
+        } else if (mapped) {
+            memcpy(hostFrame, mapped, frameBytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else {
+            std::cerr << "glMapBufferRange (pack) failed: 0x" << std::hex << glGetError() << std::dec << std::endl;
+        }
+        auto mapEnd = Clock::now();
+        mapTimes.push_back(std::chrono::duration<double, std::milli>(mapEnd - mapStart).count());
+        latencies.push_back(std::chrono::duration<double, std::milli>(mapEnd - slot.issueTime).count());
+    };
+
+    auto asyncStart = Clock::now();
+    for (int i = 0; i < testIterations; i++) {
+        ReadbackSlot& slot = ring[i % ringSize];
+        if (slot.fence) {
+            retire(slot);
+        }
+
+        TraceScope span("issue", "readback", i);
+        gpuTrace.begin("convert", i);
+        drawConversionFrame(mainWorker.yTexture, mainWorker.uvTexture);
+        gpuTrace.end();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        slot.issueTime = Clock::now();
+        slot.frame = i;
+        gpuTrace.begin("read", i);
+        glReadPixels(0, 0, frameWidth, frameHeight, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        gpuTrace.end();
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+        gpuTrace.collect(false);
+        PollGpuDisjoint();
+    }
+    for (int k = 0; k < ringSize; k++) {
+        ReadbackSlot& slot = ring[(testIterations + k) % ringSize];
+        if (slot.fence) {
+            retire(slot);
+        }
+    }
+    double asyncSeconds = std::chrono::duration<double>(Clock::now() - asyncStart).count();
+    gpuTrace.collect(true);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    for (ReadbackSlot& slot : ring) {
+        glDeleteBuffers(1, &slot.pbo);
+    }
+
+    result.syncRead = recordStats("readback/sync", syncTimes);
+    result.asyncLatency = recordStats("readback/async_latency", latencies);
+    result.mapCopy = recordStats("readback/map_copy", mapTimes);
+    result.syncFps = testIterations / syncSeconds;
+    result.asyncFps = testIterations / asyncSeconds;
+    result.syncBandwidth = result.syncRead.p50 > 0 ? frameBytes / (result.syncRead.p50 * 1.0e6) : 0;
+    result.asyncBandwidth = frameBytes * result.asyncFps / 1.0e9;
+    return result;
+}
+
+// Benchmark and verify every shader variant on the same input. Each variant is
+// its own program, specialized by the preprocessor rather than uniforms.
+void runShaderVariantMatrix(const uint8_t* nv12) {
+    std::vector<ShaderVariant> variants = BuildShaderVariantMatrix();
+    const size_t rgbaBytes = static_cast<size_t>(frameWidth) * frameHeight * 4;
+    uint8_t* rgba = hostArena.get("verify/rgba", rgbaBytes);
+    GLuint defaultProgram = mainWorker.program;
+    ShaderVariant defaultVariant = activeVariant;
+
+    struct VariantRow {
+        std::string name;
+        PerfStats stats;
+        AccuracyReport accuracy;
+        bool built;
+    };
+    std::vector<VariantRow> rows;
+
+    for (const ShaderVariant& variant : variants) {
+        std::cout << "\n--- Variant " << variant.name << " ---" << std::endl;
+        VariantRow row;
+        row.name = variant.name;
+
+        GLuint program = buildVariantProgram(variant);
+        row.built = program != 0;
+        if (!row.built) {
+            accuracyFailed = true;
+            rows.push_back(row);
+            continue;
+        }
+
+        mainWorker.program = program;
+        activeVariant = variant;
+        row.stats = runPerfTest("variant").cpu;
+
+        beginConversionPass();
+        drawConversionFrame(mainWorker.yTexture, mainWorker.uvTexture);
+        readbackToHost(rgba);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        uint8_t* reference = hostArena.get("verify/reference", rgbaBytes);
+        ThreadPool pool(cpuThreads);
+        ConvertNV12ToRGBA(nv12, nv12 + static_cast<size_t>(frameWidth) * frameHeight, reference,
+                          frameWidth, frameHeight, variant.coeffs, DetectCpuSimdLevel(), &pool);
+        row.accuracy = CompareRGBA(rgba, reference, frameWidth, frameHeight, accuracyTolerance);
+        PrintAccuracyReport(variant.name.c_str(), row.accuracy);
+        if (!row.accuracy.passed) {
+            accuracyFailed = true;
+        }
+
+        rows.push_back(row);
+        glDeleteProgram(program);
+    }
+    mainWorker.program = defaultProgram;
+    activeVariant = defaultVariant;
+
+    std::cout << "\nShader Variant Matrix (" << frameWidth << "x" << frameHeight << ", " << testIterations << " iterations):" << std::endl;
+    std::cout << "  Variant                    Mean ms    P50 ms    P99 ms   MaxErr  Accuracy" << std::endl;
+    for (const VariantRow& row : rows) {
+        char line[200];
+        if (!row.built) {
+            snprintf(line, sizeof(line), "  %-24s  (build failed)", row.name.c_str());
+        } else {
+            int maxErr = std::max({ row.accuracy.channels[0].maxAbsError, row.accuracy.channels[1].maxAbsError,
+                                    row.accuracy.channels[2].maxAbsError });
+            snprintf(line, sizeof(line), "  %-24s %9.3f %9.3f %9.3f %8d  %s", row.name.c_str(),
+                     row.stats.mean, row.stats.p50, row.stats.p99, maxErr, row.accuracy.passed ? "PASS" : "FAIL");
+        }
+        std::cout << line << std::endl;
+    }
+}
+
+// GL upload formats of one input plane
+void getPlaneTexFormat(const PlaneLayout& plane, GLenum& internalFormat, GLenum& format, GLenum& type) {
+    format = plane.channels == 2 ? GL_RG : GL_RED;
+    if (plane.bytesPerSample == 2) {
+        internalFormat = plane.channels == 2 ? GL_RG16_EXT : GL_R16_EXT;
+        type = GL_UNSIGNED_SHORT;
+    } else {
+        internalFormat = plane.channels == 2 ? GL_RG8 : GL_R8;
+        type = GL_UNSIGNED_BYTE;
+    }
+}
+
+// Create one texture per plane of a packed input frame, in texture unit order
+std::vector<GLuint> createInputTextures(InputFormat format, const uint8_t* frame) {
+    std::vector<GLuint> textures;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const PlaneLayout& plane : InputPlanes(format, frameWidth, frameHeight)) {
+        GLenum internalFormat, dataFormat, type;
+        getPlaneTexFormat(plane, internalFormat, dataFormat, type);
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, plane.width, plane.height, 0, dataFormat, type,
+                     frame + plane.offset);
+        SetNV12SamplerState();
+        textures.push_back(texture);
+    }
+    return textures;
+}
+
+// Re-upload every plane of a packed input frame
+void uploadInputFrame(InputFormat format, const uint8_t* frame, const std::vector<GLuint>& textures) {
+    std::vector<PlaneLayout> planes = InputPlanes(format, frameWidth, frameHeight);
+    for (size_t i = 0; i < planes.size(); i++) {
+        GLenum internalFormat, dataFormat, type;
+        getPlaneTexFormat(planes[i], internalFormat, dataFormat, type);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planes[i].width, planes[i].height, dataFormat, type,
+                        frame + planes[i].offset);
+    }
+}
+
+// Create the render targets for an output format, attached to a new FBO
+bool createOutputTargets(OutputFormat format, std::vector<GLuint>& targets, GLuint& framebuffer) {
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    GLenum internalFormat = GL_RGBA8;
+    if (format == OutputFormat::RGB565) internalFormat = GL_RGB565;
+    if (format == OutputFormat::PlanarRGB) internalFormat = GL_R8;
+
+    std::vector<GLenum> drawBuffers;
+    for (int i = 0; i < OutputTargetCount(format); i++) {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, frameWidth, frameHeight);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, texture, 0);
+        targets.push_back(texture);
+        drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+    }
+    glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Framebuffer for " << OutputFormatName(format) << " output is not complete! Status: "
+                  << status << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Format pair benchmark results
+struct FormatPairResult {
+    FormatPair pair;
+    std::string skipReason;  // non-empty if the pair could not run
+    PerfStats upload;        // CPU: glTexSubImage2D of every plane + glFinish
+    PerfStats convert;       // CPU: conversion draw + glFinish
+    AccuracyReport accuracy;
+};
+
+// Upload, convert and verify one input/output format pair with its own textures,
+// program and render targets. The main-run resources are swapped out for the
+// duration so the shared benchmark loop and readback can be used.
+FormatPairResult runFormatPair(const FormatPair& pair) {
+    FormatPairResult result;
+    result.pair = pair;
+    if (pair.input == InputFormat::P010 && !hasGLExtension("GL_EXT_texture_norm16")) {
+        result.skipReason = "GL_EXT_texture_norm16 not supported";
+        return result;
+    }
+
+    ShaderVariant variant = activeVariant;
+    variant.name += "+" + pair.name;
+    for (const std::string& define : FormatShaderDefines(pair)) {
+        variant.defines.push_back(define);
+    }
+    GLuint program = buildVariantProgram(variant);
+    if (!program) {
+        result.skipReason = "program build failed";
+        accuracyFailed = true;
+        return result;
+    }
+
+    uint8_t* frame = hostArena.get("format/input", InputFrameSize(pair.input, frameWidth, frameHeight));
+    FillInputTestPattern(pair.input, testPattern, frame, frameWidth, frameHeight);
+    std::vector<GLuint> planes = createInputTextures(pair.input, frame);
+    std::vector<GLuint> targets;
+    GLuint pairFbo = 0;
+    if (!createOutputTargets(pair.output, targets, pairFbo)) {
+        result.skipReason = "render target not supported";
+    } else {
+        // Upload path: every plane from host memory each iteration
+        std::vector<double> uploadTimes;
+        uploadTimes.reserve(testIterations);
+        glFinish();
+        for (int i = 0; i < testIterations; i++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            uploadInputFrame(pair.input, frame, planes);
+            glFinish();
+            auto end = std::chrono::high_resolution_clock::now();
+            uploadTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        result.upload = recordStats("format/" + pair.name + "/upload", uploadTimes);
+
+        GLuint savedProgram = mainWorker.program;
+        GLuint savedY = mainWorker.yTexture;
+        GLuint savedUV = mainWorker.uvTexture;
+        GLuint savedFbo = mainWorker.fbo;
+        mainWorker.program = program;
+        mainWorker.yTexture = planes[0];
+        mainWorker.uvTexture = planes[1];
+        mainWorker.fbo = pairFbo;
+        if (planes.size() > 2) {
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, planes[2]);
+        }
+
+        result.convert = runPerfTest("format/" + pair.name).cpu;
+
+        // Read every target back and reassemble RGBA8 for the comparison
+        const size_t pixels = static_cast<size_t>(frameWidth) * frameHeight;
+        uint8_t* rgba = hostArena.get("verify/rgba", pixels * 4);
+        beginConversionPass();
+        drawConversionFrame(mainWorker.yTexture, mainWorker.uvTexture);
+        if (pair.output == OutputFormat::PlanarRGB) {
+            uint8_t* plane = hostArena.get("format/plane", pixels * 4);
+            for (int c = 0; c < 3; c++) {
+                glReadBuffer(GL_COLOR_ATTACHMENT0 + c);
+                readbackToHost(plane);
+                for (size_t i = 0; i < pixels; i++) {
+                    rgba[i * 4 + c] = plane[i * 4];
+                }
+            }
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+        } else {
+            // RGB565 reads back as RGBA8, expanded by the driver
+            readbackToHost(rgba);
+            if (pair.output == OutputFormat::BGRA) {
+                SwapRedBlue(rgba, pixels);
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        mainWorker.program = savedProgram;
+        mainWorker.yTexture = savedY;
+        mainWorker.uvTexture = savedUV;
+        mainWorker.fbo = savedFbo;
+
+        uint8_t* reference = hostArena.get("verify/reference", pixels * 4);
+        ThreadPool pool(cpuThreads);
+        int tolerance = accuracyTolerance;
+        if (pair.input == InputFormat::P010) {
+            // 10-bit reference straight from the 16-bit words; a driver that drops
+            // GL_R16_EXT to 8 bits lands off it by more than the tighter allowance
+            const uint16_t* samples = reinterpret_cast<const uint16_t*>(frame);
+            ConvertP010ToRGBA(samples, samples + pixels, reference, frameWidth, frameHeight,
+                              activeVariant.coeffs, &pool);
+            tolerance = std::min(tolerance, p010Tolerance);
+        } else {
+            uint8_t* nv12 = hostArena.get("format/nv12", NV12FrameSize(frameWidth, frameHeight));
+            InputToNV12(pair.input, frame, nv12, frameWidth, frameHeight);
+            ConvertNV12ToRGBA(nv12, nv12 + pixels, reference, frameWidth, frameHeight,
+                              activeVariant.coeffs, DetectCpuSimdLevel(), &pool);
+        }
+
+        if (pair.output == OutputFormat::RGB565) {
+            // A reference value near a 5-bit boundary may round to the neighbouring code
+            QuantizeRGBAToRGB565(reference, pixels);
+            tolerance += 8;
+        }
+        result.accuracy = CompareRGBA(rgba, reference, frameWidth, frameHeight, tolerance);
+        PrintAccuracyReport(pair.name.c_str(), result.accuracy);
+        if (!result.accuracy.passed) {
+            accuracyFailed = true;
+        }
+    }
+
+    glDeleteFramebuffers(1, &pairFbo);
+    glDeleteTextures(static_cast<GLsizei>(targets.size()), targets.data());
+    glDeleteTextures(static_cast<GLsizei>(planes.size()), planes.data());
+    glDeleteProgram(program);
+    return result;
+}
+
+// Benchmark and verify each format pair and print a comparison table
+void runFormatMatrix(const std::vector<FormatPair>& pairs) {
+    std::vector<FormatPairResult> rows;
+    for (const FormatPair& pair : pairs) {
+        std::cout << "\n--- Format " << pair.name << " ---" << std::endl;
+        rows.push_back(runFormatPair(pair));
+        if (!rows.back().skipReason.empty()) {
+            std::cout << "Skipped: " << rows.back().skipReason << std::endl;
+        }
+    }
+
+    const double mpixels = static_cast<double>(frameWidth) * frameHeight / 1e6;
+    std::cout << "\nFormat Pairs (" << frameWidth << "x" << frameHeight << ", variant " << activeVariant.name
+              << ", " << testIterations << " iterations):" << std::endl;
+    std::cout << "  Format pair             In MB  Out MB  Upload ms  Convert ms    P99 ms   Mpixel/s  MaxErr  Accuracy" << std::endl;
+    for (const FormatPairResult& row : rows) {
+        double inMB = InputFrameSize(row.pair.input, frameWidth, frameHeight) / 1e6;
+        double outMB = mpixels * OutputBytesPerPixel(row.pair.output);
+        char line[220];
+        if (!row.skipReason.empty()) {
+            snprintf(line, sizeof(line), "  %-22s %6.2f %7.2f  (%s)", row.pair.name.c_str(), inMB, outMB,
+                     row.skipReason.c_str());
+        } else {
+            int maxErr = std::max({ row.accuracy.channels[0].maxAbsError, row.accuracy.channels[1].maxAbsError,
+                                    row.accuracy.channels[2].maxAbsError });
+            double mpixelsPerSec = row.convert.p50 > 0 ? mpixels / (row.convert.p50 / 1000.0) : 0.0;
+            snprintf(line, sizeof(line), "  %-22s %6.2f %7.2f %10.3f %11.3f %9.3f %10.1f %7d  %s", row.pair.name.c_str(),
+                     inMB, outMB, row.upload.p50, row.convert.p50, row.convert.p99, mpixelsPerSec, maxErr,
+                     row.accuracy.passed ? "PASS" : "FAIL");
+        }
+        std::cout << line << std::endl;
+    }
+}
+
+// Benchmark and verify every chroma sampling strategy on the main-run input.
+// Each strategy gets its own Y/UV textures (mutable or immutable, LINEAR or
+// NEAREST chroma) and program, and reports upload and conversion time. Accuracy
+// is checked against the CPU reference with the same upsampling; the PSNR
+// against the bilinear reference shows what NEAREST costs in quality.
+void runChromaSamplingMatrix(const uint8_t* nv12, const PerfResult& mainRun) {
+    std::cout << "\n--- Chroma sampling strategies ---" << std::endl;
+
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    const bool es31 = major > 3 || (major == 3 && minor >= 1);
+
+    struct SamplingRow {
+        ChromaSampling sampling;
+        std::string skipReason;
+        PerfStats upload;
+        PerfStats convert;
+        bool hasGpuTime = false;
+        PerfStats gpu;
+        AccuracyReport accuracy;
+        double psnrVsLinear = 0;
+    };
+    std::vector<SamplingRow> rows;
+
+    const size_t rgbaBytes = static_cast<size_t>(frameWidth) * frameHeight * 4;
+    const uint8_t* uvPlane = nv12 + static_cast<size_t>(frameWidth) * frameHeight;
+    uint8_t* rgba = hostArena.get("verify/rgba", rgbaBytes);
+    uint8_t* linearReference = hostArena.get("sampling/linear_reference", rgbaBytes);
+    uint8_t* nearestReference = nullptr;
+    ThreadPool pool(cpuThreads);
+    ConvertNV12ToRGBA(nv12, uvPlane, linearReference, frameWidth, frameHeight, activeVariant.coeffs,
+                      DetectCpuSimdLevel(), &pool);
+
+    for (const ChromaSampling& sampling : samplingStrategies) {
+        SamplingRow row;
+        row.sampling = sampling;
+        if (ChromaSamplingNeedsEs31(sampling) && !es31) {
+            row.skipReason = "needs OpenGL ES 3.1";
+            rows.push_back(row);
+            continue;
+        }
+
+        ShaderVariant variant = activeVariant;
+        variant.name += "+" + sampling.name;
+        for (const std::string& define : ChromaSamplingDefines(sampling)) {
+            variant.defines.push_back(define);
+        }
+        GLuint program = buildVariantProgram(variant, ChromaSamplingNeedsEs31(sampling) ? "310 es" : nullptr);
+        if (!program) {
+            row.skipReason = "program build failed";
+            accuracyFailed = true;
+            rows.push_back(row);
+            continue;
+        }
+
+        GLuint yTex, uvTex;
+        CreateNV12Textures(frameWidth, frameHeight, nv12, sampling.immutable, sampling.nearest ? GL_NEAREST : GL_LINEAR,
+                           yTex, uvTex);
+        GLuint savedProgram = mainWorker.program;
+        GLuint savedY = mainWorker.yTexture;
+        GLuint savedUV = mainWorker.uvTexture;
+        mainWorker.program = program;
+        mainWorker.yTexture = yTex;
+        mainWorker.uvTexture = uvTex;
+
+        // Re-specifying the contents is where immutable storage can skip validation
+        std::vector<double> uploadTimes;
+        uploadTimes.reserve(testIterations);
+        glFinish();
+        for (int i = 0; i < testIterations; i++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            UploadWorkerFrame(mainWorker, nv12);
+            glFinish();
+            auto end = std::chrono::high_resolution_clock::now();
+            uploadTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        row.upload = recordStats("sampling/" + sampling.name + "/upload", uploadTimes);
+
+        PerfResult perf = runPerfTest("sampling/" + sampling.name);
+        row.convert = perf.cpu;
+        row.hasGpuTime = perf.hasGpuTime;
+        row.gpu = perf.gpu;
+
+        beginConversionPass();
+        drawConversionFrame(yTex, uvTex);
+        readbackToHost(rgba);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        mainWorker.program = savedProgram;
+        mainWorker.yTexture = savedY;
+        mainWorker.uvTexture = savedUV;
+        glDeleteTextures(1, &yTex);
+        glDeleteTextures(1, &uvTex);
+        glDeleteProgram(program);
+
+        const uint8_t* reference = linearReference;
+        if (sampling.nearest) {
+            if (!nearestReference) {
+                nearestReference = hostArena.get("verify/reference", rgbaBytes);
+                ConvertNV12ToRGBA(nv12, uvPlane, nearestReference, frameWidth, frameHeight, activeVariant.coeffs,
+                                  DetectCpuSimdLevel(), &pool, ChromaFilter::Nearest);
+            }
+            reference = nearestReference;
+        }
+        row.accuracy = CompareRGBA(rgba, reference, frameWidth, frameHeight, accuracyTolerance);
+        PrintAccuracyReport(sampling.name.c_str(), row.accuracy);
+        if (!row.accuracy.passed) {
+            accuracyFailed = true;
+        }
+        AccuracyReport quality = CompareRGBA(rgba, linearReference, frameWidth, frameHeight, accuracyTolerance);
+        row.psnrVsLinear = std::min({ quality.channels[0].psnr, quality.channels[1].psnr, quality.channels[2].psnr });
+        rows.push_back(row);
+    }
+
+    std::cout << "\nChroma Sampling Strategies (" << frameWidth << "x" << frameHeight << ", variant "
+              << activeVariant.name << ", " << testIterations << " iterations):" << std::endl;
+    std::cout << "  Strategy              Upload ms  Convert ms    P99 ms   GPU P50   vs main  PSNR vs linear  Accuracy"
+              << std::endl;
+    for (const SamplingRow& row : rows) {
+        char line[220];
+        if (!row.skipReason.empty()) {
+            snprintf(line, sizeof(line), "  %-20s  (%s)", row.sampling.name.c_str(), row.skipReason.c_str());
+        } else {
+            char gpu[16], psnr[16];
+            if (row.hasGpuTime) {
+                snprintf(gpu, sizeof(gpu), "%9.3f", row.gpu.p50);
+            } else {
+                snprintf(gpu, sizeof(gpu), "%9s", "n/a");
+            }
+            if (std::isinf(row.psnrVsLinear)) {
+                snprintf(psnr, sizeof(psnr), "%11s", "identical");
+            } else {
+                snprintf(psnr, sizeof(psnr), "%8.2f dB", row.psnrVsLinear);
+            }
+            double speedup = row.convert.p50 > 0 ? mainRun.cpu.p50 / row.convert.p50 : 0;
+            snprintf(line, sizeof(line), "  %-20s %10.3f %11.3f %9.3f %s %8.2fx %15s  %s", row.sampling.name.c_str(),
+                     row.upload.p50, row.convert.p50, row.convert.p99, gpu, speedup, psnr,
+                     row.accuracy.passed ? "PASS" : "FAIL");
+        }
+        std::cout << line << std::endl;
+    }
+}
+
+// Benchmark the multi-pixel fragment path: a quarter-resolution pass where each
+// fragment converts a 2x2 block into four render targets, followed by a
+// full-resolution resolve into the main output. Both passes are timed alone and
+// together, and the resolved image is verified against the CPU reference.
+void runMultiPixelTest(const uint8_t* nv12, const PerfResult& single) {
+    std::cout << "\n--- Multi-pixel fragment path (2x2 per fragment) ---" << std::endl;
+
+    // textureGather needs GLSL ES 3.10, and every stage of a program must use the same version
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    const bool useGather = major > 3 || (major == 3 && minor >= 1);
+    std::vector<std::string> defines = activeVariant.defines;
+    std::string vsSource = vertexShaderSource;
+    std::string blockSource = blockFragmentShaderSource;
+    if (useGather) {
+        defines.push_back("USE_TEXTURE_GATHER");
+        vsSource = withGlslVersion(vsSource, "310 es");
+        blockSource = withGlslVersion(blockSource, "310 es");
+    }
+    blockSource = InjectShaderDefines(blockSource.c_str(), defines);
+
+    GLuint blockProgram = buildProgram(vsSource.c_str(), blockSource.c_str());
+    GLuint resolveProgram = buildProgram(vertexShaderSource, resolveFragmentShaderSource);
+    if (!blockProgram || !resolveProgram) {
+        std::cerr << "Multi-pixel programs failed to build" << std::endl;
+        glDeleteProgram(blockProgram);
+        glDeleteProgram(resolveProgram);
+        accuracyFailed = true;
+        return;
+    }
+    glUseProgram(blockProgram);
+    glUniform1i(glGetUniformLocation(blockProgram, "yTexture"), 0);
+    glUniform1i(glGetUniformLocation(blockProgram, "uvTexture"), 1);
+    glUseProgram(resolveProgram);
+    const char* blockNames[4] = { "blockTL", "blockTR", "blockBL", "blockBR" };
+    for (int i = 0; i < 4; i++) {
+        glUniform1i(glGetUniformLocation(resolveProgram, blockNames[i]), i);
+    }
+
+    // Quarter-resolution targets, one per position in the 2x2 block
+    const int blockWidth = (frameWidth + 1) / 2;
+    const int blockHeight = (frameHeight + 1) / 2;
+    GLuint blockTargets[4];
+    GLuint blockFbo;
+    glGenTextures(4, blockTargets);
+    glGenFramebuffers(1, &blockFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, blockFbo);
+    const GLenum drawBuffers[4] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
+    for (int i = 0; i < 4; i++) {
+        glBindTexture(GL_TEXTURE_2D, blockTargets[i]);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, blockWidth, blockHeight);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[i], GL_TEXTURE_2D, blockTargets[i], 0);
+    }
+    glDrawBuffers(4, drawBuffers);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Multi-pixel framebuffer is not complete! Status: " << status << std::endl;
+        glDeleteFramebuffers(1, &blockFbo);
+        glDeleteTextures(4, blockTargets);
+        glDeleteProgram(blockProgram);
+        glDeleteProgram(resolveProgram);
+        accuracyFailed = true;
+        return;
+    }
+
+    auto drawBlockPass = [&]() {
+        glBindFramebuffer(GL_FRAMEBUFFER, blockFbo);
+        glViewport(0, 0, blockWidth, blockHeight);
+        glUseProgram(blockProgram);
+        drawConversionFrame(mainWorker.yTexture, mainWorker.uvTexture);
+    };
+    auto drawResolvePass = [&]() {
+        glBindFramebuffer(GL_FRAMEBUFFER, mainWorker.fbo);
+        glViewport(0, 0, frameWidth, frameHeight);
+        glUseProgram(resolveProgram);
+        for (int i = 0; i < 4; i++) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, blockTargets[i]);
+        }
+        glBindVertexArray(mainWorker.vao);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    };
+    auto timePass = [&](const std::function<void()>& draw) {
+        std::vector<double> times;
+        times.reserve(testIterations);
+        glFinish();
+        for (int i = 0; i < testIterations; i++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            draw();
+            glFinish();
+            auto end = std::chrono::high_resolution_clock::now();
+            times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return times;
+    };
+
+    PerfStats blockStats = recordStats("multipixel/block", timePass(drawBlockPass));
+    PerfStats resolveStats = recordStats("multipixel/resolve", timePass([&]() {
+        drawResolvePass();
+    }));
+    PerfStats totalStats = recordStats("multipixel/total", timePass([&]() {
+        drawBlockPass();
+        drawResolvePass();
+    }));
+
+    uint8_t* rgba = hostArena.get("verify/rgba", static_cast<size_t>(frameWidth) * frameHeight * 4);
+    glBindFramebuffer(GL_FRAMEBUFFER, mainWorker.fbo);
+    readbackToHost(rgba);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    bool accurate = verifyAgainstReference("Multi-pixel", rgba, nv12, activeVariant.coeffs);
+
+    glDeleteFramebuffers(1, &blockFbo);
+    glDeleteTextures(4, blockTargets);
+    glDeleteProgram(blockProgram);
+    glDeleteProgram(resolveProgram);
+
+    // Texture fetch instructions, texels read and fragment invocations per output
+    // pixel. A bilinear chroma sample reads 4 texels; the block reads its 3x3
+    // chroma neighbourhood once with 9 texelFetch.
+    const double blockFetches = ((useGather ? 1.0 : 4.0) + 9.0) / 4.0;
+    const double blockTexels = (4.0 + 9.0) / 4.0;
+    std::cout << "\nMulti-pixel vs Single-pixel Fragment (" << frameWidth << "x" << frameHeight << ", "
+              << testIterations << " iterations, luma via " << (useGather ? "textureGather" : "texelFetch") << "):" << std::endl;
+    std::cout << "  Pass                       P50 ms    P99 ms  Fetches/px  Texels/px  Invocations/px" << std::endl;
+    auto printRow = [](const char* name, const PerfStats& stats, double fetches, double texels, double invocations) {
+        char line[160];
+        snprintf(line, sizeof(line), "  %-24s %8.3f %9.3f %11.2f %10.2f %15.2f", name, stats.p50, stats.p99, fetches,
+                 texels, invocations);
+        std::cout << line << std::endl;
+    };
+    printRow("single-pixel", single.cpu, 2.0, 5.0, 1.0);
+    printRow("2x2 block pass", blockStats, blockFetches, blockTexels, 0.25);
+    printRow("resolve pass", resolveStats, 1.0, 1.0, 1.0);
+    printRow("2x2 block + resolve", totalStats, blockFetches + 1.0, blockTexels + 1.0, 1.25);
+    std::cout << "Block pass vs single-pixel: " << (blockStats.p50 > 0 ? single.cpu.p50 / blockStats.p50 : 0)
+              << "x, with resolve: " << (totalStats.p50 > 0 ? single.cpu.p50 / totalStats.p50 : 0)
+              << "x, accuracy " << (accurate ? "PASS" : "FAIL") << std::endl;
+}
+
+// Test pattern for stream number `stream` of a multi-stream test: frame `stream`
+// of the selected pattern with luma shifted per stream and U/V swapped on odd
+// streams, so frames converted from the wrong stream fail the accuracy check
+void fillStreamTestPattern(uint8_t* frame, int width, int height, int stream) {
+    const size_t lumaSize = static_cast<size_t>(width) * height;
+    const size_t frameSize = NV12FrameSize(width, height);
+    GenerateNV12Pattern(testPattern, frame, frame + lumaSize, width, height, stream);
+    for (size_t p = 0; p < lumaSize; p++) {
+        frame[p] = static_cast<uint8_t>(frame[p] + stream * 37);
+    }
+    if (stream % 2) {
+        for (size_t p = lumaSize; p < frameSize; p += 2) {
+            std::swap(frame[p], frame[p + 1]);
+        }
+    }
+}
+
+// Batched multi-stream conversion. For each batch size K, K small NV12 streams
+// are converted into tiles of an RGBA8 atlas two ways: K draws with per-stream
+// 2D textures (one glDrawElements + glBindTexture per frame, as in runPerfTest),
+// and one instanced draw sampling a GL_TEXTURE_2D_ARRAY with one layer per
+// stream. Per-frame cost is reported as a function of K.
+void runBatchSweep(const std::vector<int>& sizes) {
+    const int savedWidth = frameWidth;
+    const int savedHeight = frameHeight;
+    frameWidth = batchStreamSize.width;
+    frameHeight = batchStreamSize.height;
+    std::cout << "\n--- Batched conversion (" << frameWidth << "x" << frameHeight << " streams) ---" << std::endl;
+
+    std::vector<std::string> defines = activeVariant.defines;
+    defines.push_back("INPUT_TEXTURE_ARRAY");
+    std::string batchFs = InjectShaderDefines(fragmentShaderSource, defines);
+    GLuint batchProgram = buildProgram(batchVertexShaderSource, batchFs.c_str());
+    if (!batchProgram) {
+        accuracyFailed = true;
+        frameWidth = savedWidth;
+        frameHeight = savedHeight;
+        return;
+    }
+
+    GLint maxLayers = 0, maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+    struct BatchRow {
+        int batch;
+        PerfStats separate;   // K draws, per batch
+        PerfStats instanced;  // one draw, per batch
+        bool accurate;
+    };
+    std::vector<BatchRow> rows;
+    const size_t frameSize = NV12FrameSize(frameWidth, frameHeight);
+    const size_t lumaSize = static_cast<size_t>(frameWidth) * frameHeight;
+    const int chromaWidth = NV12ChromaWidth(frameWidth);
+    const int chromaHeight = NV12ChromaHeight(frameHeight);
+
+    for (int batch : sizes) {
+        const int tilesPerRow = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(batch))));
+        const int tileRows = (batch + tilesPerRow - 1) / tilesPerRow;
+        const int atlasWidth = tilesPerRow * frameWidth;
+        const int atlasHeight = tileRows * frameHeight;
+        if (batch > maxLayers || atlasWidth > maxTextureSize || atlasHeight > maxTextureSize) {
+            std::cout << "Skipping batch " << batch << ": exceeds GL_MAX_ARRAY_TEXTURE_LAYERS " << maxLayers
+                      << " or GL_MAX_TEXTURE_SIZE " << maxTextureSize << std::endl;
+            continue;
+        }
+
+        // Distinct content per stream so a wrong layer or tile shows up in the check
+        uint8_t* frames = hostArena.get("batch/frames", frameSize * batch);
+        for (int i = 0; i < batch; i++) {
+            fillStreamTestPattern(frames + frameSize * i, frameWidth, frameHeight, i);
+        }
+
+        // Per-stream 2D textures and the layered copies of the same frames
+        std::vector<GLuint> yTextures(batch), uvTextures(batch);
+        for (int i = 0; i < batch; i++) {
+            createNV12Textures(yTextures[i], uvTextures[i]);
+            const uint8_t* frame = frames + frameSize * i;
+            glBindTexture(GL_TEXTURE_2D, yTextures[i]);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frameWidth, frameHeight, GL_RED, GL_UNSIGNED_BYTE, frame);
+            glBindTexture(GL_TEXTURE_2D, uvTextures[i]);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, chromaWidth, chromaHeight, GL_RG, GL_UNSIGNED_BYTE, frame + lumaSize);
+        }
+
+        GLuint yArray, uvArray;
+        glGenTextures(1, &yArray);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, yArray);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R8, frameWidth, frameHeight, batch);
+        glGenTextures(1, &uvArray);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, uvArray);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RG8, chromaWidth, chromaHeight, batch);
+        for (int i = 0; i < batch; i++) {
+            const uint8_t* frame = frames + frameSize * i;
+            glBindTexture(GL_TEXTURE_2D_ARRAY, yArray);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, frameWidth, frameHeight, 1, GL_RED, GL_UNSIGNED_BYTE, frame);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, uvArray);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, chromaWidth, chromaHeight, 1, GL_RG, GL_UNSIGNED_BYTE,
+                            frame + lumaSize);
+        }
+        for (GLuint array : { yArray, uvArray }) {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+
+        GLuint atlas, atlasFbo;
+        glGenTextures(1, &atlas);
+        glBindTexture(GL_TEXTURE_2D, atlas);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, atlasWidth, atlasHeight);
+        glGenFramebuffers(1, &atlasFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, atlasFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas, 0);
+
+        auto drawSeparate = [&]() {
+            glBindFramebuffer(GL_FRAMEBUFFER, atlasFbo);
+            glUseProgram(mainWorker.program);
+            for (int i = 0; i < batch; i++) {
+                glViewport((i % tilesPerRow) * frameWidth, (i / tilesPerRow) * frameHeight, frameWidth, frameHeight);
+                drawConversionFrame(yTextures[i], uvTextures[i]);
+            }
+        };
+        auto drawInstanced = [&]() {
+            glBindFramebuffer(GL_FRAMEBUFFER, atlasFbo);
+            glViewport(0, 0, atlasWidth, atlasHeight);
+            glUseProgram(batchProgram);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, yArray);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, uvArray);
+            glBindVertexArray(mainWorker.vao);
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, batch);
+        };
+        auto timeBatches = [&](const std::function<void()>& draw) {
+            std::vector<double> times;
+            times.reserve(testIterations);
+            glFinish();
+            for (int i = 0; i < testIterations; i++) {
+                auto start = std::chrono::high_resolution_clock::now();
+                draw();
+                glFinish();
+                auto end = std::chrono::high_resolution_clock::now();
+                times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+            return times;
+        };
+
+        glUseProgram(batchProgram);
+        glUniform1i(glGetUniformLocation(batchProgram, "yTexture"), 0);
+        glUniform1i(glGetUniformLocation(batchProgram, "uvTexture"), 1);
+        glUniform1i(glGetUniformLocation(batchProgram, "tilesPerRow"), tilesPerRow);
+        glUniform2f(glGetUniformLocation(batchProgram, "tileScale"), 2.0f * frameWidth / atlasWidth,
+                    2.0f * frameHeight / atlasHeight);
+        glUseProgram(mainWorker.program);
+        glUniform1i(glGetUniformLocation(mainWorker.program, "yTexture"), 0);
+        glUniform1i(glGetUniformLocation(mainWorker.program, "uvTexture"), 1);
+
+        BatchRow row;
+        row.batch = batch;
+        const std::string name = "batch/k" + std::to_string(batch);
+        row.separate = recordStats(name + "/separate", timeBatches(drawSeparate));
+        row.instanced = recordStats(name + "/instanced", timeBatches(drawInstanced));
+
+        // Verify every tile of the instanced output
+        drawInstanced();
+        uint8_t* atlasPixels = hostArena.get("batch/atlas", static_cast<size_t>(atlasWidth) * atlasHeight * 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, atlasWidth, atlasHeight, GL_RGBA, GL_UNSIGNED_BYTE, atlasPixels);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        row.accurate = true;
+        uint8_t* tile = hostArena.get("verify/rgba", lumaSize * 4);
+        uint8_t* reference = hostArena.get("verify/reference", lumaSize * 4);
+        ThreadPool pool(cpuThreads);
+        for (int i = 0; i < batch; i++) {
+            const uint8_t* frame = frames + frameSize * i;
+            int tileX = (i % tilesPerRow) * frameWidth;
+            int tileY = (i / tilesPerRow) * frameHeight;
+            for (int y = 0; y < frameHeight; y++) {
+                memcpy(tile + static_cast<size_t>(y) * frameWidth * 4,
+                       atlasPixels + (static_cast<size_t>(tileY + y) * atlasWidth + tileX) * 4,
+                       static_cast<size_t>(frameWidth) * 4);
+            }
+            ConvertNV12ToRGBA(frame, frame + lumaSize, reference, frameWidth, frameHeight,
+                              activeVariant.coeffs, DetectCpuSimdLevel(), &pool);
+            AccuracyReport report = CompareRGBA(tile, reference, frameWidth, frameHeight, accuracyTolerance);
+            if (!report.passed) {
+                PrintAccuracyReport(("Batch " + std::to_string(batch) + " stream " + std::to_string(i)).c_str(), report);
+                row.accurate = false;
+                accuracyFailed = true;
+            }
+        }
+        std::cout << "Batch " << batch << " (" << tilesPerRow << "x" << tileRows << " atlas): accuracy "
+                  << (row.accurate ? "PASS" : "FAIL") << std::endl;
+        rows.push_back(row);
+
+        glDeleteFramebuffers(1, &atlasFbo);
+        glDeleteTextures(1, &atlas);
+        glDeleteTextures(1, &yArray);
+        glDeleteTextures(1, &uvArray);
+        glDeleteTextures(batch, yTextures.data());
+        glDeleteTextures(batch, uvTextures.data());
+    }
+    glDeleteProgram(batchProgram);
+
+    std::cout << "\nBatched Conversion (" << frameWidth << "x" << frameHeight << " streams, variant "
+              << activeVariant.name << ", " << testIterations << " iterations, P50):" << std::endl;
+    std::cout << "  Batch   K draws ms   per frame   1 draw ms   per frame   Frames/s (1 draw)  Speedup  Accuracy" << std::endl;
+    for (const BatchRow& row : rows) {
+        double separateFrame = row.separate.p50 / row.batch;
+        double instancedFrame = row.instanced.p50 / row.batch;
+        char line[200];
+        snprintf(line, sizeof(line), "  %5d %12.3f %11.4f %11.3f %11.4f %19.1f %7.2fx  %s", row.batch,
+                 row.separate.p50, separateFrame, row.instanced.p50, instancedFrame,
+                 instancedFrame > 0 ? 1000.0 / instancedFrame : 0.0,
+                 row.instanced.p50 > 0 ? row.separate.p50 / row.instanced.p50 : 0.0, row.accurate ? "PASS" : "FAIL");
+        std::cout << line << std::endl;
+    }
+
+    frameWidth = savedWidth;
+    frameHeight = savedHeight;
+}
+
+// One row of the multi-context scaling table
+struct ThreadScalingResult {
+    int threads;
+    bool sharedProgram;
+    double fps;             // aggregate frames/s over all threads
+    PerfStats latency;      // per-frame draw + glFinish, all threads pooled
+    double minThreadP50;    // spread of the per-thread P50 latency
+    double maxThreadP50;
+    bool accurate;
+    std::string skipped;    // why the row was not run, e.g. the driver's context limit
+};
+
+// Convert one independent stream per thread, each thread with its own EGL context,
+// quad, textures and framebuffer. With sharedProgram the contexts share the main
+// context's object namespace and use mainWorker.program; otherwise every thread
+// compiles its own copy. All threads finish setup before any starts timing.
+// streams and references hold one NV12 frame / RGBA reference per thread, back to back.
+ThreadScalingResult runThreadScalingTest(int threadCount, bool sharedProgram, const uint8_t* streams,
+                                         const uint8_t* references) {
+    using Clock = std::chrono::high_resolution_clock;
+    const size_t frameSize = NV12FrameSize(frameWidth, frameHeight);
+    const size_t rgbaSize = static_cast<size_t>(frameWidth) * frameHeight * 4;
+
+    ThreadScalingResult result = {};
+    result.threads = threadCount;
+    result.sharedProgram = sharedProgram;
+
+    std::vector<ConversionWorker> workers(threadCount);
+    for (int t = 0; t < threadCount; t++) {
+        ConversionWorker& worker = workers[t];
+        if (!CreateWorkerContext(worker, display, eglConfig, sharedProgram ? mainWorker.context : EGL_NO_CONTEXT)) {
+            // Not a conversion failure: the driver ran out of contexts, so the row is skipped
+            result.skipped = "EGL context " + std::to_string(t + 1) + " of " + std::to_string(threadCount) +
+                             " could not be created";
+            std::cerr << "Skipping " << threadCount << " threads: " << result.skipped << std::endl;
+            for (ConversionWorker& created : workers) {
+                if (created.context != EGL_NO_CONTEXT) {
+                    eglDestroyContext(display, created.context);
+                }
+                if (created.surface != EGL_NO_SURFACE) {
+                    eglDestroySurface(display, created.surface);
+                }
+            }
+            return result;
+        }
+        if (sharedProgram) {
+            worker.program = mainWorker.program;
+        }
+    }
+    if (sharedProgram) {
+        // Sampler uniforms are program state: set once here, not from the threads
+        SetConversionSamplerUnits(mainWorker.program);
+        glFinish();
+    }
+    std::string fsSource = InjectShaderDefines(fragmentShaderSource, activeVariant.defines);
+
+    struct ThreadOutput {
+        bool ok = false;
+        std::vector<double> latencies;
+        Clock::time_point start, end;
+        uint8_t* rgba = nullptr;
+    };
+    std::vector<ThreadOutput> outputs(threadCount);
+    // Readback buffers for all threads, taken here: the arena is not thread-safe
+    uint8_t* threadRgba = hostArena.get("threads/rgba", rgbaSize * threadCount);
+    for (int t = 0; t < threadCount; t++) {
+        outputs[t].rgba = threadRgba + rgbaSize * t;
+    }
+
+    std::mutex mutex;
+    std::condition_variable startSignal;
+    int readyThreads = 0;
+    bool go = false;
+
+    auto threadMain = [&](int t) {
+        ConversionWorker& worker = workers[t];
+        ThreadOutput& out = outputs[t];
+        bool current = MakeWorkerCurrent(worker);
+        if (current) {
+            if (!sharedProgram) {
+                worker.program = buildProgram(vertexShaderSource, fsSource.c_str());
+                if (worker.program) {
+                    SetConversionSamplerUnits(worker.program);
+                }
+            }
+            InitWorkerGeometry(worker);
+            out.ok = worker.program != 0 && InitWorkerFrame(worker, streams + frameSize * t, frameWidth, frameHeight);
+            if (out.ok) {
+                // Warm-up draw so driver-side lazy setup is not timed
+                BeginWorkerPass(worker);
+                DrawWorkerFrame(worker, worker.yTexture, worker.uvTexture);
+                glFinish();
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            readyThreads++;
+            startSignal.notify_all();
+            startSignal.wait(lock, [&] { return go; });
+        }
+
+        if (out.ok) {
+            out.latencies.reserve(testIterations);
+            out.start = Clock::now();
+            for (int i = 0; i < testIterations; i++) {
+                auto start = Clock::now();
+                DrawWorkerFrame(worker, worker.yTexture, worker.uvTexture);
+                glFinish();
+                out.latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            }
+            out.end = Clock::now();
+
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, frameWidth, frameHeight, GL_RGBA, GL_UNSIGNED_BYTE, out.rgba);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        if (current) {
+            ReleaseWorkerFrame(worker);
+            ReleaseWorkerGeometry(worker);
+            if (!sharedProgram && worker.program) {
+                glDeleteProgram(worker.program);
+            }
+        }
+        DestroyWorkerContext(worker);
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back(threadMain, t);
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        startSignal.wait(lock, [&] { return readyThreads == threadCount; });
+        go = true;
+    }
+    startSignal.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<double> pooled;
+    Clock::time_point first = Clock::time_point::max();
+    Clock::time_point last = Clock::time_point::min();
+    result.accurate = true;
+    result.minThreadP50 = 0;
+    result.maxThreadP50 = 0;
+    for (int t = 0; t < threadCount; t++) {
+        const ThreadOutput& out = outputs[t];
+        if (!out.ok) {
+            std::cerr << "Thread " << t << " failed to set up its context" << std::endl;
+            result.accurate = false;
+            continue;
+        }
+        double p50 = computeStats(out.latencies).p50;
+        result.minThreadP50 = pooled.empty() ? p50 : std::min(result.minThreadP50, p50);
+        pooled.insert(pooled.end(), out.latencies.begin(), out.latencies.end());
+        first = std::min(first, out.start);
+        last = std::max(last, out.end);
+
+        result.maxThreadP50 = std::max(result.maxThreadP50, p50);
+
+        AccuracyReport report = CompareRGBA(out.rgba, references + rgbaSize * t, frameWidth, frameHeight,
+                                            accuracyTolerance);
+        if (!report.passed) {
+            PrintAccuracyReport(("Thread " + std::to_string(t)).c_str(), report);
+            result.accurate = false;
+        }
+    }
+    if (!result.accurate) {
+        accuracyFailed = true;
+    }
+    if (pooled.empty()) {
+        return result;
+    }
+
+    const std::string name = std::string("threads/") + (sharedProgram ? "shared" : "separate") + "/n" +
+                             std::to_string(threadCount);
+    result.latency = recordStats(name, pooled);
+    double span = std::chrono::duration<double>(last - first).count();
+    result.fps = span > 0 ? pooled.size() / span : 0;
+    return result;
+}
+
+// Run the multi-context test for every thread count and print aggregate
+// throughput, per-thread latency and scaling efficiency against one thread
+void runThreadScaling(const std::vector<int>& counts) {
+    std::cout << "\n--- Multi-context scaling (" << frameWidth << "x" << frameHeight << " per stream) ---" << std::endl;
+
+    const int maxThreads = *std::max_element(counts.begin(), counts.end());
+    const size_t frameSize = NV12FrameSize(frameWidth, frameHeight);
+    const size_t lumaSize = static_cast<size_t>(frameWidth) * frameHeight;
+    uint8_t* streams = hostArena.get("threads/streams", frameSize * maxThreads);
+    uint8_t* references = hostArena.get("threads/references", lumaSize * 4 * maxThreads);
+    hostArena.reserve("threads/rgba", lumaSize * 4 * maxThreads);
+    ThreadPool pool(cpuThreads);
+    for (int t = 0; t < maxThreads; t++) {
+        uint8_t* stream = streams + frameSize * t;
+        fillStreamTestPattern(stream, frameWidth, frameHeight, t);
+        ConvertNV12ToRGBA(stream, stream + lumaSize, references + lumaSize * 4 * t, frameWidth, frameHeight,
+                          activeVariant.coeffs, DetectCpuSimdLevel(), &pool);
+    }
+
+    std::vector<ThreadScalingResult> rows;
+    for (bool shared : { true, false }) {
+        if ((shared && !threadSharedProgram) || (!shared && !threadSeparatePrograms)) {
+            continue;
+        }
+        for (int count : counts) {
+            rows.push_back(runThreadScalingTest(count, shared, streams, references));
+        }
+    }
+
+    const double mpixels = static_cast<double>(frameWidth) * frameHeight / 1e6;
+    std::cout << "\nMulti-context Scaling (variant " << activeVariant.name << ", " << testIterations
+              << " frames per thread, " << std::thread::hardware_concurrency() << " hardware threads):" << std::endl;
+    std::cout << "  Program    Threads   Frames/s   Mpix/s  Efficiency   P50 ms   P99 ms   Thread P50 min-max  Accuracy" << std::endl;
+    for (const ThreadScalingResult& row : rows) {
+        if (!row.skipped.empty()) {
+            char line[200];
+            snprintf(line, sizeof(line), "  %-9s %8d   skipped: %s", row.sharedProgram ? "shared" : "separate",
+                     row.threads, row.skipped.c_str());
+            std::cout << line << std::endl;
+            continue;
+        }
+        // Efficiency: aggregate throughput relative to N x the single-thread run of the same mode
+        double single = 0;
+        for (const ThreadScalingResult& other : rows) {
+            if (other.sharedProgram == row.sharedProgram && other.threads == 1) {
+                single = other.fps;
+            }
+        }
+        char efficiency[16] = "-";
+        if (single > 0) {
+            snprintf(efficiency, sizeof(efficiency), "%.0f%%", 100.0 * row.fps / (single * row.threads));
+        }
+        char line[200];
+        snprintf(line, sizeof(line), "  %-9s %8d %10.1f %8.1f %11s %8.3f %8.3f   %7.3f - %-7.3f  %s",
+                 row.sharedProgram ? "shared" : "separate", row.threads, row.fps, row.fps * mpixels, efficiency,
+                 row.latency.p50, row.latency.p99, row.minThreadP50, row.maxThreadP50,
+                 row.accurate ? "PASS" : "FAIL");
+        std::cout << line << std::endl;
+    }
+}
+
+// Benchmark the compute-shader path for every workgroup size x pixels-per-invocation
+// configuration on the main-run textures, verify each against the CPU reference,
+// and print them next to the fragment path
+void runComputeSweep(const uint8_t* nv12, const PerfResult& fragment) {
+    std::cout << "\n--- Compute shader path ---" << std::endl;
+    if (!InitComputeFunctions()) {
+        std::cout << "Compute path not available, skipped" << std::endl;
+        return;
+    }
+
+    struct ComputeRow {
+        ComputeConfig config;
+        bool built = false;
+        PerfStats stats;
+        bool hasGpuTime = false;
+        PerfStats gpu;
+        bool accurate = false;
+    };
+    std::vector<ComputeRow> rows;
+
+    GLuint output = CreateComputeOutputTexture(frameWidth, frameHeight);
+    GLuint computeFbo;
+    glGenFramebuffers(1, &computeFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, computeFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, output, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    uint8_t* rgba = hostArena.get("verify/rgba", static_cast<size_t>(frameWidth) * frameHeight * 4);
+
+    // The fragment baseline row is verified like the compute rows: one frame
+    // through the main conversion pass, read back from its framebuffer
+    beginConversionPass();
+    drawConversionFrame(mainWorker.yTexture, mainWorker.uvTexture);
+    readbackToHost(rgba);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    const bool fragmentAccurate = verifyAgainstReference("Fragment (quad)", rgba, nv12, activeVariant.coeffs);
+
+    for (const ComputeConfig& config : BuildComputeSweep(computeWorkgroups, computePixelBlocks)) {
+        ComputeRow row;
+        row.config = config;
+        GLuint program = BuildComputeProgram(computeShaderSource, config, activeVariant.defines);
+        row.built = program != 0;
+        if (!row.built) {
+            rows.push_back(row);
+            continue;
+        }
+
+        GpuTimer gpuTimer;
+        if (useGpuTimer) {
+            gpuTimer.init();
+        }
+        std::vector<double> times;
+        times.reserve(testIterations);
+        glFinish();
+        for (int i = 0; i < testIterations; i++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            gpuTimer.begin();
+            DispatchComputeConversion(program, config, mainWorker.yTexture, mainWorker.uvTexture, output, frameWidth, frameHeight);
+            gpuTimer.end();
+            glFinish();
+            auto end = std::chrono::high_resolution_clock::now();
+            times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            gpuTimer.collect(false);
+            PollGpuDisjoint();
+        }
+        row.stats = recordStats("compute/" + config.name, times);
+        gpuTimer.collect(true);
+        if (!gpuTimer.samples().empty()) {
+            row.hasGpuTime = true;
+            row.gpu = recordStats("compute/" + config.name + "/gpu", gpuTimer.samples());
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, computeFbo);
+        readbackToHost(rgba);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        row.accurate = verifyAgainstReference(("Compute " + config.name).c_str(), rgba, nv12,
+                                              activeVariant.coeffs);
+
+        glDeleteProgram(program);
+        rows.push_back(row);
+    }
+
+    glDeleteFramebuffers(1, &computeFbo);
+    glDeleteTextures(1, &output);
+
+    // Fastest configuration by CPU P50, marked in the table
+    const ComputeRow* best = nullptr;
+    for (const ComputeRow& row : rows) {
+        if (row.built && row.accurate && (!best || row.stats.p50 < best->stats.p50)) {
+            best = &row;
+        }
+    }
+
+    std::cout << "\nCompute vs Fragment (" << frameWidth << "x" << frameHeight << ", variant " << activeVariant.name
+              << ", " << testIterations << " iterations):" << std::endl;
+    std::cout << "  Path                  P50 ms    P99 ms" << (useGpuTimer ? "   GPU P50" : "")
+              << "   Mpixel/s  vs fragment  Accuracy" << std::endl;
+    const double mpixels = static_cast<double>(frameWidth) * frameHeight / 1e6;
+    auto printRow = [&](const std::string& name, const PerfStats& stats, bool hasGpu, const PerfStats& gpu,
+                        const char* accuracy, bool isBest) {
+        char line[200];
+        snprintf(line, sizeof(line), "  %-20s %8.3f %9.3f", name.c_str(), stats.p50, stats.p99);
+        std::cout << line;
+        if (useGpuTimer) {
+            if (hasGpu) {
+                snprintf(line, sizeof(line), " %9.3f", gpu.p50);
+            } else {
+                snprintf(line, sizeof(line), " %9s", "n/a");
+            }
+            std::cout << line;
+        }
+        double speedup = stats.p50 > 0 ? fragment.cpu.p50 / stats.p50 : 0;
+        snprintf(line, sizeof(line), " %10.1f %11.2fx  %s%s", stats.p50 > 0 ? mpixels / (stats.p50 / 1000.0) : 0.0,
+                 speedup, accuracy, isBest ? "  (fastest compute)" : "");
+        std::cout << line << std::endl;
+    };
+    printRow("fragment (quad)", fragment.cpu, fragment.hasGpuTime, fragment.gpu, fragmentAccurate ? "PASS" : "FAIL",
+             false);
+    for (const ComputeRow& row : rows) {
+        if (!row.built) {
+            std::cout << "  " << row.config.name << "  (build failed)" << std::endl;
+            continue;
+        }
+        printRow(row.config.name, row.stats, row.hasGpuTime, row.gpu, row.accurate ? "PASS" : "FAIL", &row == best);
+    }
+}
+
+// Run the main conversion benchmark at each frame size, reallocating the GL
+// textures, FBO and host buffers between points, and print a scaling table
+void runResolutionSweep(const std::vector<FrameSize>& sizes, ThreadPool& patternPool) {
+    const int savedWidth = frameWidth;
+    const int savedHeight = frameHeight;
+
+    struct SweepRow {
+        FrameSize size;
+        bool fits;
+        PerfStats stats;
+        bool accurate;
+        double peakRssMb;
+    };
+    std::vector<SweepRow> rows;
+
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+    // Size the host buffers for the largest point once, so no point reallocates
+    size_t maxPixels = 0, maxNv12 = 0;
+    for (const FrameSize& size : sizes) {
+        if (size.width <= maxTextureSize && size.height <= maxTextureSize) {
+            maxPixels = std::max(maxPixels, static_cast<size_t>(size.width) * size.height);
+            maxNv12 = std::max(maxNv12, NV12FrameSize(size.width, size.height));
+        }
+    }
+    hostArena.reserve("sweep/nv12", maxNv12);
+    hostArena.reserve("verify/rgba", maxPixels * 4);
+    hostArena.reserve("verify/reference", maxPixels * 4);
+
+    releaseFrameResources();
+    for (const FrameSize& size : sizes) {
+        SweepRow row = { size, true, PerfStats(), false, 0.0 };
+        if (size.width > maxTextureSize || size.height > maxTextureSize) {
+            std::cout << "\nSkipping " << size.width << "x" << size.height
+                      << ": exceeds GL_MAX_TEXTURE_SIZE " << maxTextureSize << std::endl;
+            row.fits = false;
+            rows.push_back(row);
+            continue;
+        }
+
+        frameWidth = size.width;
+        frameHeight = size.height;
+        std::cout << "\n--- Resolution " << frameWidth << "x" << frameHeight << " ---" << std::endl;
+        ResetPeakResidentMemory();
+
+        uint8_t* nv12 = hostArena.get("sweep/nv12", NV12FrameSize(frameWidth, frameHeight));
+        generatePatternFrame(nv12, 0, patternPool);
+        initFrameResources(nv12);
+
+        row.stats = runPerfTest("sweep").cpu;
+        printStats("CPU", row.stats);
+
+        uint8_t* rgba = hostArena.get("verify/rgba", static_cast<size_t>(frameWidth) * frameHeight * 4);
+        beginConversionPass();
+        drawConversionFrame(mainWorker.yTexture, mainWorker.uvTexture);
+        readbackToHost(rgba);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        row.accurate = verifyAgainstReference("GPU", rgba, nv12, activeVariant.coeffs);
+
+        releaseFrameResources();
+        row.peakRssMb = QueryProcessMemory().peakResidentBytes / (1024.0 * 1024.0);
+        char peakRssMb[32];
+        snprintf(peakRssMb, sizeof(peakRssMb), "%.1f", row.peakRssMb);
+        results.setMetadata("sweep_" + std::to_string(frameWidth) + "x" + std::to_string(frameHeight) + "_peak_rss_mb",
+                            peakRssMb);
+        rows.push_back(row);
+    }
+
+    frameWidth = savedWidth;
+    frameHeight = savedHeight;
+
+    std::cout << "\nResolution Scaling (variant " << activeVariant.name << ", " << testIterations << " iterations):" << std::endl;
+    std::cout << "  Resolution      Mpixels   Mean ms    P50 ms    P99 ms   Mpixel/s  ns/pixel  Peak RSS MB  Accuracy" << std::endl;
+    for (const SweepRow& row : rows) {
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", row.size.width, row.size.height);
+        double mpixels = static_cast<double>(row.size.width) * row.size.height / 1e6;
+        char line[200];
+        if (!row.fits) {
+            snprintf(line, sizeof(line), "  %-14s %8.2f  (exceeds max texture size)", name, mpixels);
+        } else {
+            double mpixelsPerSec = row.stats.p50 > 0 ? mpixels / (row.stats.p50 / 1000.0) : 0.0;
+            double nsPerPixel = row.stats.p50 / mpixels;
+            snprintf(line, sizeof(line), "  %-14s %8.2f %9.3f %9.3f %9.3f %10.1f %9.3f %12.1f  %s", name, mpixels,
+                     row.stats.mean, row.stats.p50, row.stats.p99, mpixelsPerSec, nsPerPixel, row.peakRssMb,
+                     row.accurate ? "PASS" : "FAIL");
+        }
+        std::cout << line << std::endl;
+    }
+}
+
+// Run the pipelined test for each queue depth and print a throughput table
+void runPipelineSweep(const std::vector<int>& depths) {
+    std::cout << "\nPipelined Throughput (" << testIterations << " frames per depth):" << std::endl;
+    std::cout << "  Depth      FPS   Latency P50   Latency P99" << (useGpuTimer ? "   GPU P50" : "") << std::endl;
+
+    double bestFps = 0;
+    for (int depth : depths) {
+        PipelineResult r = runPipelinedTest(depth);
+        char line[160];
+        snprintf(line, sizeof(line), "  %5d %8.2f %10.3f ms %10.3f ms",
+                 r.framesInFlight, r.fps, r.latency.p50, r.latency.p99);
+        std::cout << line;
+        if (r.hasGpuTime) {
+            snprintf(line, sizeof(line), " %7.3f ms", r.gpu.p50);
+            std::cout << line;
+        }
+        // Less than 5% more throughput than any shallower depth: the GPU is saturated
+        if (bestFps > 0 && r.fps < bestFps * 1.05) {
+            std::cout << "   (saturated)";
+        }
+        std::cout << std::endl;
+        bestFps = std::max(bestFps, r.fps);
+    }
+}
+
+// Cleanup resources
+void cleanup() {
+    releaseFrameResources();
+    ReleaseWorkerGeometry(mainWorker);
+    glDeleteProgram(mainWorker.program);
+
+    DestroyWorkerContext(mainWorker);
+    eglTerminate(display);
+}
+
+#ifdef _WIN32
+// Window procedure function
+LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    switch (uMsg) {
+        case WM_CLOSE:
+            PostQuitMessage(0);
+            return 0;
+    }
+    return DefWindowProc(hwnd, uMsg, wParam, lParam);
+}
+#endif
+
+void queryGPUAdapters() {
+#ifdef _WIN32
+    // 尝试用 DXGI 来枚举 GPU
+    IDXGIFactory1* factory = nullptr;
+    std::vector<IDXGIAdapter1*> adapters;
+    
+    HRESULT hr = CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&factory);
+    if (SUCCEEDED(hr)) {
+        IDXGIAdapter1* adapter = nullptr;
+        for (UINT i = 0; factory->EnumAdapters1(i, &adapter) != DXGI_ERROR_NOT_FOUND; ++i) {
+            DXGI_ADAPTER_DESC1 desc;
+            adapter->GetDesc1(&desc);
+            
+            GPUInfo info;
+            info.device = EGL_NO_DEVICE_EXT;  // 我们不使用 EGL device
+            
+            // 将 WCHAR 转换为 string
+            char name[128];
+            wcstombs(name, desc.Description, sizeof(name));
+            info.name = name;
+            
+            // 使用 VendorID 来确定厂商
+            switch(desc.VendorId) {
+                case 0x10DE: info.vendor = "NVIDIA"; break;
+                case 0x1002: info.vendor = "AMD"; break;
+                case 0x8086: info.vendor = "Intel"; break;
+                default: info.vendor = "Unknown"; break;
+            }
+            
+            gpuList.push_back(info);
+            std::cout << "GPU " << gpuList.size()-1 << ": " << info.name 
+                     << " (" << info.vendor << ")" << std::endl;
+            
+            adapter->Release();
+        }
+        factory->Release();
+    }
+#else
+    // Every EGL device, hardware and software, through EGL_EXT_device_enumeration
+    for (const EglDeviceInfo& device : EnumerateEglDevices()) {
+        GPUInfo info;
+        info.device = device.device;
+        info.name = device.name;
+        info.vendor = device.vendor;
+        info.drmNode = device.drmNode;
+        info.software = device.software;
+        gpuList.push_back(info);
+        std::cout << "GPU " << gpuList.size() - 1 << ": " << info.name << " (" << info.vendor;
+        if (!info.drmNode.empty()) {
+            std::cout << ", " << info.drmNode;
+        }
+        std::cout << (info.software ? ", software" : "") << ")" << std::endl;
+    }
+#endif
+
+    // 如果没有找到任何设备，添加一个默认设备
+    if (gpuList.empty()) {
+        GPUInfo defaultGPU;
+        defaultGPU.device = EGL_NO_DEVICE_EXT;
+        defaultGPU.name = "Default GPU";
+        defaultGPU.vendor = "Default Vendor";
+        gpuList.push_back(defaultGPU);
+        std::cout << "Using default GPU" << std::endl;
+    }
+}
+
+// Quote one argument for the std::system command line
+std::string shellQuote(const std::string& arg) {
+#ifdef _WIN32
+    return "\"" + arg + "\"";
+#else
+    std::string quoted = "'";
+    for (char c : arg) {
+        quoted += (c == '\'') ? std::string("'\\''") : std::string(1, c);
+    }
+    return quoted + "'";
+#endif
+}
+
+// <stem>_gpu<i><ext>, so per-GPU runs of --all-gpus never share a file
+std::string perGpuPath(const std::string& path, size_t gpu) {
+    size_t dot = path.rfind('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        dot = path.size();
+    }
+    return path.substr(0, dot) + "_gpu" + std::to_string(gpu) + path.substr(dot);
+}
+
+// --all-gpus: run this executable once per GPU with the same options plus
+// --gpu <i>, then print the results side by side. Every output file (--json,
+// --csv, --trace, --output, --dump-frames) gets a per-GPU name. Separate
+// processes keep every device's EGL/driver state isolated. Returns the first
+// non-zero child exit code.
+int runOnAllGpus(int argc, char* argv[]) {
+    if (shaderCachePrune) {
+        std::cerr << "--shader-cache-prune cannot be combined with --all-gpus: each GPU run would delete "
+                  << "the entries of the others" << std::endl;
+        return -1;
+    }
+    queryGPUAdapters();
+
+    std::string forwarded = shellQuote(argv[0]);
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--all-gpus") {
+            continue;
+        }
+        if ((arg == "--gpu" || arg == "--json" || arg == "--csv" || arg == "--trace" || arg == "--output" ||
+             arg == "--dump-frames") && i + 1 < argc) {
+            i++;
+            continue;
+        }
+        forwarded += " " + shellQuote(arg);
+    }
+
+    // Per-GPU results go next to the --json file, or to temporary files
+    const bool keepJson = !resultsJsonPath.empty();
+    const std::string jsonBase = keepJson ? resultsJsonPath : "shader_perf_all_gpus.json";
+
+    std::vector<std::string> labels;
+    std::vector<ResultsReport> reports(gpuList.size());
+    int exitCode = 0;
+    for (size_t gpu = 0; gpu < gpuList.size(); gpu++) {
+        labels.push_back("GPU" + std::to_string(gpu));
+        std::string jsonPath = perGpuPath(jsonBase, gpu);
+        std::string command = forwarded + " --gpu " + std::to_string(gpu) + " --json " + shellQuote(jsonPath);
+        command += " --output " + (outputPath.empty() ? std::string("none") : shellQuote(perGpuPath(outputPath, gpu)));
+        if (!resultsCsvPath.empty()) {
+            command += " --csv " + shellQuote(perGpuPath(resultsCsvPath, gpu));
+        }
+        if (!tracePath.empty()) {
+            command += " --trace " + shellQuote(perGpuPath(tracePath, gpu));
+        }
+        if (!dumpFramesPath.empty()) {
+            command += " --dump-frames " + shellQuote(perGpuPath(dumpFramesPath, gpu));
+        }
+
+        std::cout << "\n===== GPU " << gpu << ": " << gpuList[gpu].name << " =====" << std::endl;
+        int status = std::system(command.c_str());
+#ifndef _WIN32
+        status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+        if (status != 0) {
+            std::cerr << "GPU " << gpu << " run exited with code " << status << std::endl;
+            if (exitCode == 0) {
+                exitCode = status;
+            }
+        }
+        if (!LoadResultsJson(jsonPath.c_str(), reports[gpu])) {
+            std::cerr << "No results from GPU " << gpu << std::endl;
+        }
+        if (!keepJson) {
+            std::remove(jsonPath.c_str());
+        }
+    }
+
+    PrintRunComparison(labels, reports);
+    return exitCode;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+    // 在 main 函数开头添加
+    SetEnvironmentVariable("ANGLE_DEFAULT_PLATFORM", "d3d11");
+    SetEnvironmentVariable("ANGLE_D3D11_FORCE_DISCRETE_GPU", "1");
+    SetEnvironmentVariable("ANGLE_PLATFORM_ANGLE_DEVICE_TYPE", "hardware");
+    SetEnvironmentVariable("ANGLE_DEBUG_DISPLAY", "1");
+    SetEnvironmentVariable("ANGLE_DEBUG_LAYERS", "1");
+#endif
+    
+    int selectedGPU = 0;
+
+    // 处理命令行参数
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--gpu" && i + 1 < argc) {
+            selectedGPU = std::atoi(argv[i + 1]);
+            i++;
+        }
+        else if (arg == "--all-gpus") {
+            allGpus = true;
+        }
+        else if (arg == "--list-gpus") {
+            queryGPUAdapters();
+            return 0;
+        }
         else if (arg == "--verbose") {
             verbose = true;
         }
+        else if (arg == "--headless") {
+            headless = true;
+        }
+        else if (arg == "--gpu-timer") {
+            useGpuTimer = true;
+        }
+        else if (arg == "--frames-in-flight" && i + 1 < argc) {
+            pipelineDepths = { std::max(1, std::atoi(argv[i + 1])) };
+            i++;
+        }
+        else if (arg == "--pipeline-sweep") {
+            pipelineDepths = { 1, 2, 3, 4, 6, 8 };
+        }
+        else if (arg == "--streaming") {
+            streamingMode = true;
+        }
+        else if (arg == "--pbo-ring" && i + 1 < argc) {
+            pboRingSize = std::max(1, std::atoi(argv[i + 1]));
+            i++;
+        }
+        else if (arg == "--cpu-reference") {
+            cpuReference = true;
+        }
+        else if (arg == "--cpu-only") {
+            cpuOnly = true;
+        }
+        else if (arg == "--cpu-threads" && i + 1 < argc) {
+            cpuThreads = std::atoi(argv[i + 1]);
+            i++;
+        }
+        else if (arg == "--cpu-simd" && i + 1 < argc) {
+            if (!ParseCpuSimdLevel(argv[i + 1], cpuSimdLevel)) {
+                std::cerr << "Unknown SIMD level: " << argv[i + 1] << " (scalar, sse2, avx2)" << std::endl;
+                return -1;
+            }
+            i++;
+        }
+        else if (arg == "--variant" && i + 1 < argc) {
+            if (!FindShaderVariant(argv[i + 1], activeVariant)) {
+                std::cerr << "Unknown shader variant: " << argv[i + 1] << ". Available:";
+                for (const ShaderVariant& v : BuildShaderVariantMatrix()) std::cerr << " " << v.name;
+                std::cerr << std::endl;
+                return -1;
+            }
+            i++;
+        }
+        else if (arg == "--variants") {
+            runVariantMatrix = true;
+        }
+        else if (arg == "--formats") {
+            formatPairs = BuildFormatPairs();
+        }
+        else if (arg == "--format" && i + 1 < argc) {
+            FormatPair pair;
+            if (!FindFormatPair(argv[i + 1], pair)) {
+                std::cerr << "Unknown format pair '" << argv[i + 1] << "'. Available:";
+                for (const FormatPair& candidate : BuildFormatPairs()) {
+                    std::cerr << " " << candidate.name;
+                }
+                std::cerr << std::endl;
+                return -1;
+            }
+            formatPairs.push_back(pair);
+            i++;
+        }
+        else if (arg == "--sampling") {
+            samplingStrategies = BuildChromaSamplingMatrix();
+        }
+        else if (arg == "--sampling-strategy" && i + 1 < argc) {
+            ChromaSampling sampling;
+            if (!FindChromaSampling(argv[i + 1], sampling)) {
+                std::cerr << "Unknown sampling strategy '" << argv[i + 1] << "'. Available:";
+                for (const ChromaSampling& candidate : BuildChromaSamplingMatrix()) {
+                    std::cerr << " " << candidate.name;
+                }
+                std::cerr << std::endl;
+                return -1;
+            }
+            samplingStrategies.push_back(sampling);
+            i++;
+        }
+        else if (arg == "--shader-cache" && i + 1 < argc) {
+            shaderCacheDir = argv[i + 1];
+            i++;
+        }
+        else if (arg == "--shader-cache-bench") {
+            shaderCacheBench = true;
+        }
+        else if (arg == "--shader-cache-prune") {
+            shaderCachePrune = true;
+        }
+        else if (arg == "--compile-bench") {
+            compileBenchPrograms = 120;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                compileBenchPrograms = std::max(1, std::atoi(argv[i + 1]));
+                i++;
+            }
+        }
+        else if (arg == "--tolerance" && i + 1 < argc) {
+            accuracyTolerance = std::max(0, std::atoi(argv[i + 1]));
+            i++;
+        }
+        else if (arg == "--readback") {
+            readbackMode = true;
+        }
+        else if (arg == "--readback-ring" && i + 1 < argc) {
+            readbackRingSize = std::max(1, std::atoi(argv[i + 1]));
+            readbackMode = true;
+            i++;
+        }
+        else if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[i + 1];
+            if (outputPath == "none") {
+                outputPath.clear();
+            } else if (!ImageFileFormatFromPath(outputPath, outputFormat)) {
+                std::cerr << "Unknown output format for " << outputPath << " (use .bmp, .ppm, .png, .y4m or .rgb)" << std::endl;
+                return -1;
+            }
+            i++;
+        }
+        else if (arg == "--dump-frames" && i + 1 < argc) {
+            dumpFramesPath = argv[i + 1];
+            if (!ImageFileFormatFromPath(dumpFramesPath, dumpFramesFormat) || !IsSequenceFormat(dumpFramesFormat)) {
+                std::cerr << "--dump-frames needs a .y4m or .rgb file" << std::endl;
+                return -1;
+            }
+            readbackMode = true;
+            i++;
+        }
+        else if (arg == "--size" && i + 1 < argc) {
+            FrameSize size;
+            if (!parseFrameSize(argv[i + 1], size)) {
+                return -1;
+            }
+            frameWidth = size.width;
+            frameHeight = size.height;
+            i++;
+        }
+        else if (arg == "--iterations" && i + 1 < argc) {
+            testIterations = std::max(1, std::atoi(argv[i + 1]));
+            i++;
+        }
+        else if (arg == "--pattern" && i + 1 < argc) {
+            if (!ParseTestPattern(argv[i + 1], testPattern)) {
+                std::cerr << "Unknown pattern '" << argv[i + 1] << "' (gradient, noise, zoneplate, bars, moving)" << std::endl;
+                return -1;
+            }
+            i++;
+        }
+        else if (arg == "--input" && i + 1 < argc) {
+            inputPath = argv[i + 1];
+            i++;
+        }
+        else if (arg == "--sweep") {
+            sweepSizes = defaultSweepSizes;
+        }
+        else if (arg == "--sweep-sizes" && i + 1 < argc) {
+            if (!parseSizeList(argv[i + 1], sweepSizes)) {
+                return -1;
+            }
+            i++;
+        }
+        else if (arg == "--batch") {
+            batchSizes = { 1, 2, 4, 8, 16, 32, 64 };
+        }
+        else if (arg == "--batch-sizes" && i + 1 < argc) {
+            if (!parseIntList(argv[i + 1], batchSizes)) {
+                return -1;
+            }
+            i++;
+        }
+        else if (arg == "--thread-scaling") {
+            threadCounts = { 1, 2, 4, 8 };
+        }
+        else if (arg == "--thread-counts" && i + 1 < argc) {
+            if (!parseIntList(argv[i + 1], threadCounts)) {
+                return -1;
+            }
+            i++;
+        }
+        else if (arg == "--thread-program" && i + 1 < argc) {
+            std::string mode = argv[i + 1];
+            if (mode != "shared" && mode != "separate" && mode != "both") {
+                std::cerr << "Unknown --thread-program mode '" << mode << "' (shared, separate, both)" << std::endl;
+                return -1;
+            }
+            threadSharedProgram = mode != "separate";
+            threadSeparatePrograms = mode != "shared";
+            if (threadCounts.empty()) {
+                threadCounts = { 1, 2, 4, 8 };
+            }
+            i++;
+        }
+        else if (arg == "--batch-stream" && i + 1 < argc) {
+            if (!parseFrameSize(argv[i + 1], batchStreamSize)) {
+                return -1;
+            }
+            if (batchSizes.empty()) {
+                batchSizes = { 1, 2, 4, 8, 16, 32, 64 };
+            }
+            i++;
+        }
+        else if (arg == "--multi-pixel") {
+            multiPixelMode = true;
+        }
+        else if (arg == "--compute") {
+            computeMode = true;
+        }
+        else if ((arg == "--compute-workgroups" || arg == "--compute-pixels") && i + 1 < argc) {
+            std::vector<FrameSize> sizes;
+            if (!parseSizeList(argv[i + 1], sizes)) {
+                return -1;
+            }
+            auto& target = arg == "--compute-workgroups" ? computeWorkgroups : computePixelBlocks;
+            target.clear();
+            for (const FrameSize& size : sizes) {
+                target.push_back({ size.width, size.height });
+            }
+            computeMode = true;
+            i++;
+        }
+        else if (arg == "--huge-pages") {
+            hugePages = true;
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[i + 1];
+            i++;
+        }
+        else if (arg == "--json" && i + 1 < argc) {
+            resultsJsonPath = argv[i + 1];
+            i++;
+        }
+        else if (arg == "--csv" && i + 1 < argc) {
+            resultsCsvPath = argv[i + 1];
+            i++;
+        }
+        else if (arg == "--compare" && i + 1 < argc) {
+            baselinePath = argv[i + 1];
+            i++;
+        }
+        else if (arg == "--compare-files" && i + 2 < argc) {
+            baselinePath = argv[i + 1];
+            comparePath = argv[i + 2];
+            i += 2;
+        }
+        else if (arg == "--regression-threshold" && i + 1 < argc) {
+            regressionOptions.thresholdPercent = std::max(0.0, std::atof(argv[i + 1]));
+            i++;
+        }
+        else if (arg == "--significance" && i + 1 < argc) {
+            regressionOptions.significance = std::atof(argv[i + 1]);
+            i++;
+        }
         else if (arg == "--help") {
             std::cout << "Usage: shader_perf_test.exe [options]\n"
                       << "Options:\n"
                       << "  --gpu <index>    Select GPU adapter by index.\n"
+                      << "  --list-gpus      List GPU adapters (DXGI on Windows, EGL devices elsewhere).\n"
+                      << "  --all-gpus       Run the benchmark on every GPU and compare them side by side.\n"
                       << "  --verbose        Enable verbose debug logging.\n"
+                      << "  --headless       Run without a window (surfaceless/pbuffer EGL).\n"
+                      << "  --gpu-timer      Also report GPU time from GL_EXT_disjoint_timer_query.\n"
+                      << "  --frames-in-flight <n>  Pipelined throughput test with n queued frames.\n"
+                      << "  --pipeline-sweep Pipelined test over queue depths 1, 2, 3, 4, 6, 8.\n"
+                      << "  --streaming      Upload a new NV12 frame per iteration through a PBO ring.\n"
+                      << "  --pbo-ring <n>   Number of PBOs in the streaming ring (default 3).\n"
+                      << "  --cpu-reference  Also benchmark the SIMD multithreaded CPU converter.\n"
+                      << "  --cpu-only       Convert on the CPU only, without initializing EGL.\n"
+                      << "  --cpu-threads <n>  Worker threads for the CPU converter (default: all cores).\n"
+                      << "  --cpu-simd <isa> CPU converter instruction set: scalar, sse2, avx2.\n"
+                      << "  --variant <name> Shader variant for the main run (default bt601_full_clamp).\n"
+                      << "  --variants       Benchmark and verify every shader variant.\n"
+                      << "  --batch          Convert 1..64 CIF streams per draw (texture array + instancing).\n"
+                      << "  --batch-sizes <n,...>  Batch sizes for --batch.\n"
+                      << "  --batch-stream <WxH>  Stream size for --batch (default 352x288).\n"
+                      << "  --thread-scaling Convert independent streams on 1, 2, 4, 8 threads, one EGL context each.\n"
+                      << "  --thread-counts <n,...>  Thread counts for --thread-scaling.\n"
+                      << "  --thread-program <shared|separate|both>  Share the main program or build one per context (default both).\n"
+                      << "  --multi-pixel    Benchmark 2x2 pixels per fragment (quarter-res MRT + resolve).\n"
+                      << "  --compute        Sweep the ES 3.1 compute-shader path next to the fragment path.\n"
+                      << "  --compute-workgroups <WxH,...>  Workgroup sizes for --compute.\n"
+                      << "  --compute-pixels <WxH,...>  Output pixels per invocation for --compute.\n"
+                      << "  --formats        Benchmark and verify every input/output format pair.\n"
+                      << "  --format <pair>  Benchmark one format pair, e.g. p010_to_bgra (repeatable).\n"
+                      << "  --sampling       Benchmark chroma sampling: texture/texelFetch/textureGather,\n"
+                      << "                   LINEAR vs NEAREST chroma, mutable vs immutable textures.\n"
+                      << "  --sampling-strategy <name>  Benchmark one strategy, e.g. gather_immutable (repeatable).\n"
+                      << "  --shader-cache <dir>  Cache linked program binaries on disk.\n"
+                      << "  --shader-cache-bench  Report cold vs warm program build times.\n"
+                      << "  --shader-cache-prune  Delete other drivers' entries from the shader cache.\n"
+                      << "  --compile-bench [n]   Serial vs parallel compile/link of n programs (default 120).\n"
+                      << "  --tolerance <n>  Max per-channel error vs the CPU reference (default 3).\n"
+                      << "  --readback       Benchmark blocking vs async PBO readback.\n"
+                      << "  --readback-ring <n>  Number of pack PBOs for async readback (default 3).\n"
+                      << "  --output <file>  Converted image: .bmp (default output_test.bmp), .ppm, .png, .y4m, .rgb or none.\n"
+                      << "  --dump-frames <file>  Write every async readback frame to a .y4m or .rgb sequence.\n"
+                      << "  --size <WxH>     Frame size for the conversion tests (default 3840x2160).\n"
+                      << "  --iterations <n> Frames per timed test (default 100).\n"
+                      << "  --pattern <name> Test pattern: gradient (default), noise, zoneplate, bars, moving.\n"
+                      << "  --input <file>   Convert frames from a raw .nv12/.yuv (I420, needs --size) or .y4m file.\n"
+                      << "  --sweep          Benchmark 480p, 720p, 1080p, 1440p, 4K, 8K and odd sizes.\n"
+                      << "  --sweep-sizes <WxH,...>  Benchmark the given list of frame sizes.\n"
+                      << "  --huge-pages     2 MiB-align large host buffers and advise transparent huge pages.\n"
+                      << "  --trace <file>   Write CPU and GPU stage spans as Chrome trace JSON.\n"
+                      << "  --json <file>    Write every sample and run metadata as JSON.\n"
+                      << "  --csv <file>     Write every sample as CSV (metadata in # comment lines).\n"
+                      << "  --compare <baseline.json>  Flag significant regressions against a saved run.\n"
+                      << "  --compare-files <baseline.json> <current.json>  Compare two saved runs and exit.\n"
+                      << "  --regression-threshold <pct>  Minimum median slowdown to flag (default 5).\n"
+                      << "  --significance <alpha>  Mann-Whitney U p-value cut-off (default 0.01).\n"
                       << "  --help           Show this help message.\n";
             return 0;
         }
     }
 
+    if (!comparePath.empty()) {
+        // Offline comparison of two saved runs, without touching the GPU
+        ResultsReport baseline, current;
+        if (!LoadResultsJson(baselinePath.c_str(), baseline) || !LoadResultsJson(comparePath.c_str(), current)) {
+            return -1;
+        }
+        std::vector<RegressionRow> rows = CompareResults(baseline, current, regressionOptions);
+        return PrintRegressionReport(rows, regressionOptions) == 0 ? 0 : 2;
+    }
+
+    if (!inputPath.empty()) {
+        if (!inputReader.open(inputPath, frameWidth, frameHeight)) {
+            return -1;
+        }
+        frameWidth = inputReader.width();
+        frameHeight = inputReader.height();
+        std::cout << "Input: " << inputPath << " (" << frameWidth << "x" << frameHeight << " "
+                  << InputFormatName(inputReader.format()) << ", " << inputReader.frameCount()
+                  << " frames, memory-mapped)" << std::endl;
+    }
+
+    if (allGpus) {
+        return runOnAllGpus(argc, argv);
+    }
+
+    addRunMetadata();
+    hostArena.setHugePages(hugePages);
+
+    if (!tracePath.empty()) {
+        TraceStart();
+    }
+
+    if (cpuOnly) {
+        return runCpuOnly();
+    }
+
     // 查询可用GPU
     queryGPUAdapters();
 
@@ -632,104 +3449,235 @@ int main(int argc, char* argv[]) {
     std::cout << "Using GPU " << selectedGPU << ": " 
               << gpuList[selectedGPU].name << std::endl;
 
-    // Register window class
-    WNDCLASSEX wc = {};
-    wc.cbSize = sizeof(WNDCLASSEX);
-    wc.lpfnWndProc = WindowProc;
-    wc.hInstance = GetModuleHandle(nullptr);
-    wc.lpszClassName = "ShaderPerfTest";
-    RegisterClassEx(&wc);
-
-    // Create window
-    HWND hwnd = CreateWindowEx(
-        0,
-        "ShaderPerfTest",
-        "Shader Performance Test",
-        WS_OVERLAPPEDWINDOW,
-        CW_USEDEFAULT, CW_USEDEFAULT,
-        800, 600,
-        nullptr,
-        nullptr,
-        GetModuleHandle(nullptr),
-        nullptr
-    );
-
-    if (!hwnd) {
-        std::cerr << "Failed to create window" << std::endl;
+    auto eglStart = std::chrono::high_resolution_clock::now();
+
+#ifdef _WIN32
+    HWND hwnd = nullptr;
+    if (!headless) {
+        // Register window class
+        WNDCLASSEX wc = {};
+        wc.cbSize = sizeof(WNDCLASSEX);
+        wc.lpfnWndProc = WindowProc;
+        wc.hInstance = GetModuleHandle(nullptr);
+        wc.lpszClassName = "ShaderPerfTest";
+        RegisterClassEx(&wc);
+
+        // Create window
+        hwnd = CreateWindowEx(
+            0,
+            "ShaderPerfTest",
+            "Shader Performance Test",
+            WS_OVERLAPPEDWINDOW,
+            CW_USEDEFAULT, CW_USEDEFAULT,
+            800, 600,
+            nullptr,
+            nullptr,
+            GetModuleHandle(nullptr),
+            nullptr
+        );
+
+        if (!hwnd) {
+            std::cerr << "Failed to create window" << std::endl;
+            return -1;
+        }
+
+        ShowWindow(hwnd, SW_SHOW);
+
+        // Initialize EGL and OpenGL ES
+        if (!initEGL(hwnd, selectedGPU)) {
+            return -1;
+        }
+    } else
+#endif
+    if (!initEGLHeadless(selectedGPU)) {
         return -1;
     }
 
-    ShowWindow(hwnd, SW_SHOW);
+    auto eglEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "EGL initialization (" << (headless ? "headless" : "windowed") << "): "
+              << std::chrono::duration<double, std::milli>(eglEnd - eglStart).count() << " ms" << std::endl;
+    addDriverMetadata(gpuList[selectedGPU].name);
 
-    // Initialize EGL and OpenGL ES
-    if (!initEGL(hwnd, selectedGPU)) {
-        return -1;
+    if (!shaderCacheDir.empty() && programCache.open(shaderCacheDir) && shaderCachePrune) {
+        programCache.pruneOtherDrivers();
     }
 
     if (!initShaders()) {
         return -1;
     }
 
-    initGeometryAndTextures();
+    if (shaderCacheBench) {
+        runProgramCacheBenchmark();
+    }
 
-    // 创建并初始化NV12纹理时使用测试pattern
-    uint8_t* nv12_data = new uint8_t[WIDTH * HEIGHT * 3 / 2];
-    uint8_t* y_plane = nv12_data;
-    uint8_t* uv_plane = nv12_data + (WIDTH * HEIGHT);
-    
-    FillNV12TestPattern(y_plane, uv_plane, WIDTH, HEIGHT);
+    if (compileBenchPrograms > 0) {
+        std::vector<std::vector<std::string>> defineSets;
+        for (const ShaderVariant& variant : BuildShaderVariantMatrix()) {
+            defineSets.push_back(variant.defines);
+        }
+        CompileBenchResult compile = RunCompileBenchmark(vertexShaderSource, fragmentShaderSource,
+                                                         defineSets, compileBenchPrograms);
+        PrintCompileBenchResult(compile);
+        if (!compile.allLinked) {
+            accuracyFailed = true;
+        }
+    }
+
+    InitWorkerGeometry(mainWorker);
 
-    // 创建NV12纹理并上传数据
-    glGenTextures(1, &yTexture);
-    glBindTexture(GL_TEXTURE_2D, yTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, WIDTH, HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, y_plane);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // One CPU pool for every generated pattern frame of the run
+    ThreadPool patternPool(cpuThreads);
 
-    glGenTextures(1, &uvTexture);
-    glBindTexture(GL_TEXTURE_2D, uvTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, WIDTH/2, HEIGHT/2, 0, GL_RG, GL_UNSIGNED_BYTE, uv_plane);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // 创建并初始化NV12纹理时使用测试pattern
+    uint8_t* nv12_data = hostArena.get("frame/nv12", NV12FrameSize(frameWidth, frameHeight));
+    loadInputFrame(nv12_data, patternPool);
 
-    // Initialize FBO
-    initFramebuffer();
+    // 创建NV12纹理并上传数据, Initialize FBO
+    initFrameResources(nv12_data);
 
     // Run performance test
-    PerfResult result = runPerfTest();
+    PerfResult result = runPerfTest("convert");
 
     // Output results
-    std::cout << "Performance Test Results:" << std::endl;
-    std::cout << "Average Time: " << result.avgTime << " ms" << std::endl;
-    std::cout << "Minimum Time: " << result.minTime << " ms" << std::endl;
-    std::cout << "Maximum Time: " << result.maxTime << " ms" << std::endl;
+    std::cout << "Performance Test Results (variant " << activeVariant.name << "):" << std::endl;
+    printStats("CPU", result.cpu);
+    if (result.hasGpuTime) {
+        printStats("GPU", result.gpu);
+        if (result.gpuDisjointFrames > 0) {
+            std::cout << "GPU Disjoint Frames (dropped): " << result.gpuDisjointFrames << std::endl;
+        }
+    } else if (useGpuTimer) {
+        std::cout << "GPU Time: not available" << std::endl;
+    }
+    reportHostMemory("convert");
+
+    if (!pipelineDepths.empty()) {
+        runPipelineSweep(pipelineDepths);
+    }
+
+    if (!sweepSizes.empty()) {
+        runResolutionSweep(sweepSizes, patternPool);
+        initFrameResources(nv12_data);
+    }
+
+    if (streamingMode) {
+        // Synthetic source: a short loop of pattern frames, generated up front so
+        // generation is not timed. Odd frames have inverted luma, so consecutive
+        // uploads differ even for static patterns.
+        const int patternFrames = 8;
+        size_t frameSize = NV12FrameSize(frameWidth, frameHeight);
+        uint8_t* sourceFrames = nullptr;
+        if (!inputReader.isOpen()) {
+            auto start = std::chrono::high_resolution_clock::now();
+            sourceFrames = hostArena.get("stream/source", frameSize * patternFrames);
+            for (int f = 0; f < patternFrames; f++) {
+                uint8_t* source = sourceFrames + frameSize * f;
+                generatePatternFrame(source, f, patternPool);
+                if (f % 2) {
+                    for (int i = 0; i < frameWidth * frameHeight; i++) {
+                        source[i] = 255 - source[i];
+                    }
+                }
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            std::cout << "Generated " << patternFrames << " " << TestPatternName(testPattern) << " frames in "
+                      << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+        }
+        int frameIndex = 0;
+        auto nextFrame = [&]() -> const uint8_t* {
+            if (inputReader.isOpen()) {
+                return inputReader.nextFrame();
+            }
+            return sourceFrames + frameSize * (frameIndex++ % patternFrames);
+        };
+
+        StreamingResult stream = runStreamingTest(nextFrame, inputReader.isOpen() ? inputReader.format() : InputFormat::NV12,
+                                                  pboRingSize);
+        std::cout << "\nStreaming Upload Results (PBO ring of " << stream.ringSize << "):" << std::endl;
+        printStats("Upload (CPU staging)", stream.upload);
+        printStats("Frame (CPU, upload + convert issue)", stream.frame);
+        if (stream.hasGpuTime) {
+            printStats("GPU Upload", stream.gpuUpload);
+            printStats("GPU Conversion", stream.gpuConvert);
+        }
+        std::cout << "End-to-end throughput: " << stream.fps << " fps ("
+                  << (stream.fps > 0 ? 1000.0 / stream.fps : 0) << " ms/frame)" << std::endl;
+        std::cout << "Static-texture conversion for comparison: " << result.cpu.p50 << " ms/frame (P50)" << std::endl;
+    }
+
+    if (runVariantMatrix) {
+        runShaderVariantMatrix(nv12_data);
+    }
+
+    if (!formatPairs.empty()) {
+        runFormatMatrix(formatPairs);
+    }
+
+    if (!samplingStrategies.empty()) {
+        runChromaSamplingMatrix(nv12_data, result);
+    }
+
+    if (computeMode) {
+        runComputeSweep(nv12_data, result);
+    }
+
+    if (multiPixelMode) {
+        runMultiPixelTest(nv12_data, result);
+    }
+
+    if (!batchSizes.empty()) {
+        runBatchSweep(batchSizes);
+    }
+
+    if (!threadCounts.empty()) {
+        runThreadScaling(threadCounts);
+    }
+
+    if (cpuReference) {
+        uint8_t* cpuRgba = hostArena.get("frame/rgba", static_cast<size_t>(frameWidth) * frameHeight * 4);
+        ThreadPool pool(cpuThreads);
+        PerfResult cpuResult = runCpuConversionTest(nv12_data, cpuRgba, pool);
+        printCpuConversionResult(cpuResult, pool);
+        std::cout << "GPU path for comparison: " << result.cpu.p50 << " ms/frame (P50)" << std::endl;
+    }
+
+    if (readbackMode) {
+        ReadbackResult rb = runReadbackTest(readbackRingSize);
+        std::cout << "\nReadback Results (" << frameWidth << "x" << frameHeight << " RGBA, PBO ring of " << rb.ringSize << "):" << std::endl;
+        printStats("Blocking glReadPixels", rb.syncRead);
+        printStats("Async readback latency", rb.asyncLatency);
+        printStats("PBO map + copy", rb.mapCopy);
+        std::cout << "Blocking: " << rb.syncFps << " fps, read bandwidth " << rb.syncBandwidth << " GB/s" << std::endl;
+        std::cout << "Async:    " << rb.asyncFps << " fps, sustained bandwidth " << rb.asyncBandwidth << " GB/s" << std::endl;
+        if (!dumpFramesPath.empty()) {
+            std::cout << "Async frames queued to " << dumpFramesPath << " (" << ImageFileFormatName(dumpFramesFormat)
+                      << "); PBO map + copy includes any wait for a free writer buffer" << std::endl;
+        }
+    }
 
-    // Read RGB result
-    uint8_t* rgb_data = new uint8_t[WIDTH * HEIGHT * 3];
-    
     // Bind FBO and perform rendering
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glViewport(0, 0, WIDTH, HEIGHT);
+    glBindFramebuffer(GL_FRAMEBUFFER, mainWorker.fbo);
+    glViewport(0, 0, frameWidth, frameHeight);
     
     // Clear buffer to red (for debugging)
     glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     
     // Execute rendering
-    glUseProgram(shaderProgram);
+    glUseProgram(mainWorker.program);
     
     // Set texture uniform
-    GLint yLoc = glGetUniformLocation(shaderProgram, "yTexture");
-    GLint uvLoc = glGetUniformLocation(shaderProgram, "uvTexture");
+    GLint yLoc = glGetUniformLocation(mainWorker.program, "yTexture");
+    GLint uvLoc = glGetUniformLocation(mainWorker.program, "uvTexture");
     glUniform1i(yLoc, 0);  // texture unit 0
     glUniform1i(uvLoc, 1); // texture unit 1
     
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, yTexture);
+    glBindTexture(GL_TEXTURE_2D, mainWorker.yTexture);
     glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, uvTexture);
+    glBindTexture(GL_TEXTURE_2D, mainWorker.uvTexture);
     
-    glBindVertexArray(VAO);
+    glBindVertexArray(mainWorker.vao);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
     
     // Ensure rendering is complete
@@ -742,8 +3690,11 @@ int main(int argc, char* argv[]) {
     }
     
     // Read pixel data
-    uint8_t* rgba_data = new uint8_t[WIDTH * HEIGHT * 4];  // Using RGBA format
-    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, rgba_data);
+    uint8_t* rgba_data = hostArena.get("frame/rgba", static_cast<size_t>(frameWidth) * frameHeight * 4);  // Using RGBA format
+    if (!readbackToHost(rgba_data)) {
+        std::cerr << "PBO readback failed, falling back to glReadPixels" << std::endl;
+        glReadPixels(0, 0, frameWidth, frameHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba_data);
+    }
     
     // Check for errors again
     err = glGetError();
@@ -751,43 +3702,27 @@ int main(int argc, char* argv[]) {
         std::cerr << "OpenGL error after reading pixels: 0x" << std::hex << err << std::endl;
     }
 
-    // Convert RGBA to RGB
-    for (int i = 0; i < WIDTH * HEIGHT; i++) {
-        rgb_data[i * 3] = rgba_data[i * 4];      // R
-        rgb_data[i * 3 + 1] = rgba_data[i * 4 + 1];  // G
-        rgb_data[i * 3 + 2] = rgba_data[i * 4 + 2];  // B
-    }
-
-    delete[] rgba_data;  // Clean up RGBA data
+    // Verify the GPU output against the CPU reference
+    verifyAgainstReference("GPU", rgba_data, nv12_data, activeVariant.coeffs);
 
-    // Check if all pixel values are zero
-    bool allZero = true;
-    for (int i = 0; i < WIDTH * HEIGHT * 3; i++) {
-        if (rgb_data[i] != 0) {
-            allZero = false;
-            break;
-        }
-    }
-    if (allZero) {
-        std::cerr << "Warning: All pixel values are zero!" << std::endl;
-    } else {
-        std::cout << "Successfully read non-zero pixel values." << std::endl;
-    }
-
-    // Save as BMP file
-    SaveRGBToBMP("output_test.bmp", rgb_data, WIDTH, HEIGHT);
+    // Save the converted image (encoded on the writer thread)
+    writeOutputImage(rgba_data);
 
     // Reset FBO binding
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    // Clean up
-    delete[] nv12_data;
-    delete[] rgb_data;
+    finishImageOutput();
+    finishTrace();
+    bool regressed = !finishResults();
 
     // Cleanup resources
     cleanup();
 
     // Close the window and exit
-    DestroyWindow(hwnd);
-    return 0;
+#ifdef _WIN32
+    if (hwnd) {
+        DestroyWindow(hwnd);
+    }
+#endif
+    return accuracyFailed ? 1 : (regressed ? 2 : 0);
 } 
\ No newline at end of file
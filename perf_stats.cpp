@@ -0,0 +1,165 @@
+#include "perf_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+// Scale factor turning a MAD into a consistent estimator of the standard deviation
+static const double MAD_SCALE = 1.4826;
+
+// Consecutive in-band samples needed before the series counts as settled
+static const int WARMUP_STABLE_RUN = 5;
+
+static double median(std::vector<double> values) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return percentileSorted(values, 50.0);
+}
+
+static double medianAbsDeviation(const std::vector<double>& values, double center) {
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+    for (double v : values) {
+        deviations.push_back(std::fabs(v - center));
+    }
+    return median(deviations);
+}
+
+double percentileSorted(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    if (sorted.size() == 1) return sorted[0];
+
+    double rank = (p / 100.0) * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(std::floor(rank));
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    double frac = rank - lo;
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+}
+
+int detectWarmup(const std::vector<double>& samples) {
+    int n = static_cast<int>(samples.size());
+    if (n < 2 * WARMUP_STABLE_RUN) return 0;
+
+    // The second half of the run is the steady-state reference
+    std::vector<double> tail(samples.begin() + n / 2, samples.end());
+    double center = median(tail);
+    double spread = MAD_SCALE * medianAbsDeviation(tail, center);
+
+    // Band of +-3 sigma, but never tighter than 2% of the median
+    double band = std::max(3.0 * spread, 0.02 * center);
+
+    int run = 0;
+    for (int i = 0; i < n / 2; i++) {
+        if (std::fabs(samples[i] - center) <= band) {
+            if (++run == WARMUP_STABLE_RUN) {
+                return i - WARMUP_STABLE_RUN + 1;
+            }
+        } else {
+            run = 0;
+        }
+    }
+
+    // The first half never settles: this is drift, not a warm-up transient
+    return 0;
+}
+
+// Percentile bootstrap of the mean and median
+static void bootstrapCI(const std::vector<double>& values, const StatsOptions& options, PerfStats& stats) {
+    std::mt19937 rng(12345);  // fixed seed: reports are reproducible for the same samples
+    std::uniform_int_distribution<size_t> pick(0, values.size() - 1);
+
+    std::vector<double> means, medians, resample(values.size());
+    means.reserve(options.bootstrapResamples);
+    medians.reserve(options.bootstrapResamples);
+
+    for (int b = 0; b < options.bootstrapResamples; b++) {
+        double sum = 0;
+        for (size_t i = 0; i < values.size(); i++) {
+            resample[i] = values[pick(rng)];
+            sum += resample[i];
+        }
+        means.push_back(sum / values.size());
+
+        // Same median as the point estimate: mean of the two middle values for even n
+        size_t mid = resample.size() / 2;
+        std::nth_element(resample.begin(), resample.begin() + mid, resample.end());
+        double center = resample[mid];
+        if (resample.size() % 2 == 0) {
+            center = (center + *std::max_element(resample.begin(), resample.begin() + mid)) / 2.0;
+        }
+        medians.push_back(center);
+    }
+
+    std::sort(means.begin(), means.end());
+    std::sort(medians.begin(), medians.end());
+
+    double alpha = (1.0 - options.confidence) / 2.0 * 100.0;
+    stats.meanCILow = percentileSorted(means, alpha);
+    stats.meanCIHigh = percentileSorted(means, 100.0 - alpha);
+    stats.medianCILow = percentileSorted(medians, alpha);
+    stats.medianCIHigh = percentileSorted(medians, 100.0 - alpha);
+}
+
+PerfStats computeStats(const std::vector<double>& samples, const StatsOptions& options) {
+    PerfStats stats;
+    stats.confidence = options.confidence;
+    stats.totalSamples = static_cast<int>(samples.size());
+    if (samples.empty()) return stats;
+
+    stats.warmupSamples = options.detectWarmup ? detectWarmup(samples) : 0;
+    std::vector<double> steady(samples.begin() + stats.warmupSamples, samples.end());
+
+    // Distribution of the steady state
+    std::vector<double> sorted = steady;
+    std::sort(sorted.begin(), sorted.end());
+    stats.min = sorted.front();
+    stats.max = sorted.back();
+    stats.p50 = percentileSorted(sorted, 50.0);
+    stats.p90 = percentileSorted(sorted, 90.0);
+    stats.p99 = percentileSorted(sorted, 99.0);
+    stats.p999 = percentileSorted(sorted, 99.9);
+    stats.mad = medianAbsDeviation(steady, stats.p50);
+
+    // MAD-based outlier rejection (modified z-score)
+    std::vector<double> kept;
+    kept.reserve(steady.size());
+    double scaledMad = MAD_SCALE * stats.mad;
+    for (double v : steady) {
+        if (options.outlierThreshold > 0 && scaledMad > 0 &&
+            std::fabs(v - stats.p50) / scaledMad > options.outlierThreshold) {
+            stats.outlierSamples++;
+        } else {
+            kept.push_back(v);
+        }
+    }
+    stats.usedSamples = static_cast<int>(kept.size());
+
+    double sum = 0;
+    for (double v : kept) sum += v;
+    stats.mean = sum / kept.size();
+
+    double sq = 0;
+    for (double v : kept) sq += (v - stats.mean) * (v - stats.mean);
+    stats.stddev = kept.size() > 1 ? std::sqrt(sq / (kept.size() - 1)) : 0;
+
+    if (options.bootstrapResamples > 0 && kept.size() > 1) {
+        bootstrapCI(kept, options, stats);
+    } else {
+        stats.meanCILow = stats.meanCIHigh = stats.mean;
+        stats.medianCILow = stats.medianCIHigh = stats.p50;
+    }
+
+    return stats;
+}
+
+void printStats(const char* label, const PerfStats& stats) {
+    int ciPercent = static_cast<int>(std::lround(stats.confidence * 100));
+    std::cout << label << " Time (ms): " << stats.usedSamples << "/" << stats.totalSamples << " samples"
+              << " (warm-up " << stats.warmupSamples << ", outliers " << stats.outlierSamples << ")" << std::endl;
+    std::cout << "  Mean:   " << stats.mean << " +- " << stats.stddev
+              << "  [" << ciPercent << "% CI " << stats.meanCILow << " - " << stats.meanCIHigh << "]" << std::endl;
+    std::cout << "  Median: " << stats.p50
+              << "  [" << ciPercent << "% CI " << stats.medianCILow << " - " << stats.medianCIHigh << "]" << std::endl;
+    std::cout << "  Min: " << stats.min << "  P90: " << stats.p90 << "  P99: " << stats.p99
+              << "  P99.9: " << stats.p999 << "  Max: " << stats.max << std::endl;
+}
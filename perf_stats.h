@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+// Options for computeStats
+struct StatsOptions {
+    bool detectWarmup = true;       // drop the cold-start transient
+    double outlierThreshold = 3.5;  // modified z-score cut-off (0 disables rejection)
+    int bootstrapResamples = 2000;  // 0 disables confidence intervals
+    double confidence = 0.95;
+};
+
+// Summary statistics of a series of timings (all times in ms).
+// Percentiles, min and max are taken over the steady-state samples (warm-up removed)
+// so that tail latency stays visible; mean, stddev and the confidence intervals
+// are computed after MAD-based outlier rejection.
+struct PerfStats {
+    int totalSamples = 0;
+    int warmupSamples = 0;
+    int outlierSamples = 0;
+    int usedSamples = 0;
+
+    double mean = 0;
+    double stddev = 0;
+    double min = 0;
+    double max = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    double mad = 0;     // median absolute deviation (unscaled)
+
+    // Bootstrap confidence intervals
+    double confidence = 0.95;
+    double meanCILow = 0;
+    double meanCIHigh = 0;
+    double medianCILow = 0;
+    double medianCIHigh = 0;
+};
+
+// Index of the first steady-state sample. Warm-up ends at the first run of
+// consecutive samples that all fall inside the steady-state band (taken from the
+// second half of the run). Returns 0 if the first half never settles.
+int detectWarmup(const std::vector<double>& samples);
+
+// Linear-interpolated percentile (p in [0, 100]) of an ascending sorted series
+double percentileSorted(const std::vector<double>& sorted, double p);
+
+PerfStats computeStats(const std::vector<double>& samples, const StatsOptions& options = StatsOptions());
+
+// Print a multi-line summary, e.g. printStats("CPU", stats)
+void printStats(const char* label, const PerfStats& stats);
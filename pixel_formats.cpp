@@ -0,0 +1,189 @@
+#include "pixel_formats.h"
+#include "texture_utils.h"
+#include "test_patterns.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const InputFormat kInputFormats[] = { InputFormat::NV12, InputFormat::P010, InputFormat::I420 };
+const OutputFormat kOutputFormats[] = { OutputFormat::RGBA, OutputFormat::BGRA, OutputFormat::RGB565,
+                                        OutputFormat::PlanarRGB };
+
+} // namespace
+
+const char* InputFormatName(InputFormat format) {
+    switch (format) {
+        case InputFormat::NV12: return "nv12";
+        case InputFormat::P010: return "p010";
+        case InputFormat::I420: return "i420";
+    }
+    return "unknown";
+}
+
+const char* OutputFormatName(OutputFormat format) {
+    switch (format) {
+        case OutputFormat::RGBA: return "rgba";
+        case OutputFormat::BGRA: return "bgra";
+        case OutputFormat::RGB565: return "rgb565";
+        case OutputFormat::PlanarRGB: return "planar_rgb";
+    }
+    return "unknown";
+}
+
+std::vector<FormatPair> BuildFormatPairs() {
+    std::vector<FormatPair> pairs;
+    for (InputFormat input : kInputFormats) {
+        for (OutputFormat output : kOutputFormats) {
+            FormatPair pair;
+            pair.input = input;
+            pair.output = output;
+            pair.name = std::string(InputFormatName(input)) + "_to_" + OutputFormatName(output);
+            pairs.push_back(pair);
+        }
+    }
+    return pairs;
+}
+
+bool FindFormatPair(const std::string& name, FormatPair& pair) {
+    for (const FormatPair& candidate : BuildFormatPairs()) {
+        if (candidate.name == name) {
+            pair = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> FormatShaderDefines(const FormatPair& pair) {
+    std::vector<std::string> defines;
+    if (pair.input == InputFormat::P010) defines.push_back("INPUT_P010");
+    if (pair.input == InputFormat::I420) defines.push_back("INPUT_I420");
+    if (pair.output == OutputFormat::BGRA) defines.push_back("OUTPUT_BGRA");
+    if (pair.output == OutputFormat::PlanarRGB) defines.push_back("OUTPUT_PLANAR_RGB");
+    // RGB565 needs no shader change: the target quantizes on store
+    return defines;
+}
+
+std::vector<PlaneLayout> InputPlanes(InputFormat format, int width, int height) {
+    const int cw = NV12ChromaWidth(width);
+    const int ch = NV12ChromaHeight(height);
+    const size_t lumaSamples = static_cast<size_t>(width) * height;
+    const size_t chromaSamples = static_cast<size_t>(cw) * ch;
+
+    switch (format) {
+        case InputFormat::P010:
+            return { { "yTexture", width, height, 1, 2, 0 },
+                     { "uvTexture", cw, ch, 2, 2, lumaSamples * 2 } };
+        case InputFormat::I420:
+            return { { "yTexture", width, height, 1, 1, 0 },
+                     { "uTexture", cw, ch, 1, 1, lumaSamples },
+                     { "vTexture", cw, ch, 1, 1, lumaSamples + chromaSamples } };
+        case InputFormat::NV12:
+        default:
+            return { { "yTexture", width, height, 1, 1, 0 },
+                     { "uvTexture", cw, ch, 2, 1, lumaSamples } };
+    }
+}
+
+size_t InputFrameSize(InputFormat format, int width, int height) {
+    size_t size = 0;
+    for (const PlaneLayout& plane : InputPlanes(format, width, height)) {
+        size = std::max(size, plane.offset + static_cast<size_t>(plane.width) * plane.height *
+                                                 plane.channels * plane.bytesPerSample);
+    }
+    return size;
+}
+
+int OutputTargetCount(OutputFormat format) {
+    return format == OutputFormat::PlanarRGB ? 3 : 1;
+}
+
+int OutputBytesPerPixel(OutputFormat format) {
+    switch (format) {
+        case OutputFormat::RGB565: return 2;
+        case OutputFormat::PlanarRGB: return 3;
+        default: return 4;
+    }
+}
+
+void FillInputTestPattern(InputFormat format, TestPattern pattern, uint8_t* frame, int width, int height) {
+    std::vector<PlaneLayout> planes = InputPlanes(format, width, height);
+    if (format == InputFormat::NV12) {
+        GenerateNV12Pattern(pattern, frame + planes[0].offset, frame + planes[1].offset, width, height);
+        return;
+    }
+
+    const size_t lumaSamples = static_cast<size_t>(width) * height;
+    std::vector<uint8_t> nv12(NV12FrameSize(width, height));
+    GenerateNV12Pattern(pattern, nv12.data(), nv12.data() + lumaSamples, width, height);
+
+    if (format == InputFormat::P010) {
+        // Widen to 10 bits; the two new low bits follow the sample index so the
+        // frame carries detail that an 8-bit texture cannot hold
+        uint16_t* samples = reinterpret_cast<uint16_t*>(frame);
+        for (size_t i = 0; i < nv12.size(); i++) {
+            samples[i] = static_cast<uint16_t>(((nv12[i] << 2) | (i & 3)) << 6);
+        }
+    } else {
+        // I420: same luma, interleaved chroma split into U and V planes
+        std::copy(nv12.begin(), nv12.begin() + lumaSamples, frame + planes[0].offset);
+        const uint8_t* uv = nv12.data() + lumaSamples;
+        uint8_t* u = frame + planes[1].offset;
+        uint8_t* v = frame + planes[2].offset;
+        const size_t chromaSamples = (nv12.size() - lumaSamples) / 2;
+        for (size_t i = 0; i < chromaSamples; i++) {
+            u[i] = uv[i * 2];
+            v[i] = uv[i * 2 + 1];
+        }
+    }
+}
+
+void InputToNV12(InputFormat format, const uint8_t* frame, uint8_t* nv12, int width, int height) {
+    const size_t lumaSamples = static_cast<size_t>(width) * height;
+    const size_t chromaSamples = static_cast<size_t>(NV12ChromaWidth(width)) * NV12ChromaHeight(height);
+    const size_t nv12Size = NV12FrameSize(width, height);
+
+    switch (format) {
+        case InputFormat::NV12:
+            std::copy(frame, frame + nv12Size, nv12);
+            break;
+        case InputFormat::P010: {
+            // Same layout, one sample per 16-bit word: 10-bit value -> nearest 8-bit
+            const uint16_t* samples = reinterpret_cast<const uint16_t*>(frame);
+            for (size_t i = 0; i < nv12Size; i++) {
+                int value10 = samples[i] >> 6;
+                nv12[i] = static_cast<uint8_t>((value10 * 255 + 511) / 1023);
+            }
+            break;
+        }
+        case InputFormat::I420: {
+            std::copy(frame, frame + lumaSamples, nv12);
+            const uint8_t* u = frame + lumaSamples;
+            const uint8_t* v = u + chromaSamples;
+            uint8_t* uv = nv12 + lumaSamples;
+            for (size_t i = 0; i < chromaSamples; i++) {
+                uv[i * 2] = u[i];
+                uv[i * 2 + 1] = v[i];
+            }
+            break;
+        }
+    }
+}
+
+void QuantizeRGBAToRGB565(uint8_t* rgba, size_t pixels) {
+    static const int bits[3] = { 5, 6, 5 };
+    for (size_t i = 0; i < pixels; i++) {
+        for (int c = 0; c < 3; c++) {
+            int maxCode = (1 << bits[c]) - 1;
+            int code = (rgba[i * 4 + c] * maxCode + 127) / 255;
+            rgba[i * 4 + c] = static_cast<uint8_t>((code << (8 - bits[c])) | (code >> (2 * bits[c] - 8)));
+        }
+    }
+}
+
+void SwapRedBlue(uint8_t* rgba, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        std::swap(rgba[i * 4], rgba[i * 4 + 2]);
+    }
+}
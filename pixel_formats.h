@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class TestPattern;
+
+// YUV input layouts accepted by the conversion shader
+enum class InputFormat {
+    NV12,  // 8-bit Y + interleaved UV (GL_R8 + GL_RG8)
+    P010,  // 10-bit in 16-bit words, NV12 layout (GL_R16_EXT + GL_RG16_EXT)
+    I420,  // 8-bit Y + separate U and V planes (3x GL_R8)
+};
+
+// Render target layouts
+enum class OutputFormat {
+    RGBA,       // GL_RGBA8
+    BGRA,       // GL_RGBA8 with B and R swapped, i.e. BGRA byte order
+    RGB565,     // GL_RGB565
+    PlanarRGB,  // three GL_R8 targets through MRT
+};
+
+// One plane of an input frame
+struct PlaneLayout {
+    const char* sampler;  // uniform name in fragmentShaderSource
+    int width;
+    int height;
+    int channels;         // 1 (R) or 2 (RG)
+    int bytesPerSample;   // 1 (UNORM8) or 2 (UNORM16)
+    size_t offset;        // byte offset in the packed frame
+};
+
+struct FormatPair {
+    InputFormat input;
+    OutputFormat output;
+    std::string name;  // e.g. "p010_to_bgra"
+};
+
+const char* InputFormatName(InputFormat format);
+const char* OutputFormatName(OutputFormat format);
+
+// Every input x output combination; the first is nv12_to_rgba, the main-run format
+std::vector<FormatPair> BuildFormatPairs();
+bool FindFormatPair(const std::string& name, FormatPair& pair);
+
+// Shader #defines selecting the pair's sampling and output code
+std::vector<std::string> FormatShaderDefines(const FormatPair& pair);
+
+// Planes of a packed input frame, in texture unit order
+std::vector<PlaneLayout> InputPlanes(InputFormat format, int width, int height);
+size_t InputFrameSize(InputFormat format, int width, int height);
+
+// Render targets written per pixel (1, or 3 for planar) and bytes per output pixel
+int OutputTargetCount(OutputFormat format);
+int OutputBytesPerPixel(OutputFormat format);
+
+// Fill a packed input frame with a GenerateNV12Pattern pattern: P010 widens
+// the samples to 10 bits, I420 splits the chroma into two planes
+void FillInputTestPattern(InputFormat format, TestPattern pattern, uint8_t* frame, int width, int height);
+
+// 8-bit NV12 equivalent of an input frame, for the CPU reference converter.
+// P010 samples are rounded to 8 bits (ConvertP010ToRGBA keeps full precision).
+void InputToNV12(InputFormat format, const uint8_t* frame, uint8_t* nv12, int width, int height);
+
+// Reduce RGBA8 to RGB565 precision in place, expanding back by bit replication
+void QuantizeRGBAToRGB565(uint8_t* rgba, size_t pixels);
+
+// Swap the R and B channels of RGBA8 pixels in place
+void SwapRedBlue(uint8_t* rgba, size_t pixels);
@@ -0,0 +1,189 @@
+#include "program_cache.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kMagic[4] = { 'S', 'P', 'P', 'C' };
+const uint32_t kFormatVersion = 1;
+
+struct EntryHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint32_t identityLength;
+    uint32_t binaryLength;
+};
+
+// Driver subdirectories are named by HashString: 16 hex digits
+bool isDriverDirectoryName(const std::string& name) {
+    if (name.size() != 16) return false;
+    for (char c : name) {
+        if (!isxdigit(static_cast<unsigned char>(c))) return false;
+    }
+    return true;
+}
+
+std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+} // namespace
+
+std::string HashString(const std::string& text) {
+    uint64_t hash = 1469598103934665603ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+bool ProgramCache::open(const std::string& directory) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        std::cout << "Program binaries not supported by this driver, shader cache disabled" << std::endl;
+        return false;
+    }
+
+    driverIdentity = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+    std::string driverHash = HashString(driverIdentity);
+    cacheDirectory = directory;
+    driverDirectory = (fs::path(directory) / driverHash).string();
+
+    std::error_code ec;
+    fs::create_directories(driverDirectory, ec);
+    if (ec) {
+        std::cerr << "Cannot create shader cache directory " << driverDirectory << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    enabled = true;
+    return true;
+}
+
+void ProgramCache::pruneOtherDrivers() {
+    if (!enabled) return;
+
+    // Entries of a replaced driver can never be loaded again; those of another
+    // GPU sharing the directory can, so this only runs on request
+    const std::string driverHash = fs::path(driverDirectory).filename().string();
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(cacheDirectory, ec)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_directory() && isDriverDirectoryName(name) && name != driverHash) {
+            fs::remove_all(entry.path(), ec);
+            std::cout << "Shader cache: removed entries of another driver (" << name << ")" << std::endl;
+        }
+    }
+}
+
+std::string ProgramCache::makeKey(const char* vsSource, const char* fsSource) const {
+    std::string text = "v" + std::to_string(kFormatVersion) + "\n";
+    text += vsSource;
+    text += '\0';
+    text += fsSource;
+    return HashString(text);
+}
+
+std::string ProgramCache::entryPath(const std::string& key) const {
+    return (fs::path(driverDirectory) / (key + ".bin")).string();
+}
+
+GLuint ProgramCache::load(const std::string& key) {
+    if (!enabled) return 0;
+
+    std::ifstream file(entryPath(key), std::ios::binary);
+    if (!file) {
+        missCount++;
+        return 0;
+    }
+
+    std::error_code sizeError;
+    const uintmax_t fileSize = fs::file_size(entryPath(key), sizeError);
+
+    EntryHeader header;
+    std::string identity;
+    std::vector<char> binary;
+    bool valid = false;
+    // Lengths come from disk: check them against the file before allocating
+    if (!sizeError && file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kFormatVersion &&
+        header.identityLength == driverIdentity.size() &&
+        sizeof(header) + header.identityLength + static_cast<uintmax_t>(header.binaryLength) == fileSize) {
+        identity.resize(header.identityLength);
+        binary.resize(header.binaryLength);
+        valid = file.read(&identity[0], header.identityLength) &&
+                file.read(binary.data(), header.binaryLength) &&
+                identity == driverIdentity;
+    }
+    file.close();
+
+    GLuint program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (!program) {
+        // Corrupt, foreign or rejected by the driver: drop it and rebuild from source
+        std::error_code ec;
+        fs::remove(entryPath(key), ec);
+        missCount++;
+        return 0;
+    }
+
+    hitCount++;
+    return program;
+}
+
+void ProgramCache::store(const std::string& key, GLuint program) {
+    if (!enabled || !program) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) return;
+
+    EntryHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.binaryFormat = format;
+    header.identityLength = static_cast<uint32_t>(driverIdentity.size());
+    header.binaryLength = static_cast<uint32_t>(written);
+
+    // Write to a temporary file and rename, so concurrent readers never see a partial entry
+    std::string path = entryPath(key);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(driverIdentity.data(), driverIdentity.size());
+        file.write(binary.data(), written);
+        if (!file) return;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "gl_common.h"
+#include <cstdint>
+#include <string>
+
+// Persistent on-disk cache of linked program binaries (glGetProgramBinary /
+// glProgramBinary). Entries are keyed by a hash of the shader sources (defines
+// included) and stored under a per-driver subdirectory named after a hash of
+// GL_VENDOR/GL_RENDERER/GL_VERSION, so several drivers can share one cache
+// directory. A binary the driver rejects is deleted and rebuilt from source.
+class ProgramCache {
+public:
+    // Requires a current GL context. Returns false if the driver exposes no
+    // binary formats, in which case the cache stays disabled.
+    bool open(const std::string& directory);
+    bool isEnabled() const { return enabled; }
+
+    // Key for a vertex + fragment source pair
+    std::string makeKey(const char* vsSource, const char* fsSource) const;
+
+    // Linked program from the cache, or 0 on a miss
+    GLuint load(const std::string& key);
+    void store(const std::string& key, GLuint program);
+
+    // Remove the subdirectories of every other driver
+    void pruneOtherDrivers();
+
+    int hits() const { return hitCount; }
+    int misses() const { return missCount; }
+
+private:
+    std::string entryPath(const std::string& key) const;
+
+    bool enabled = false;
+    std::string cacheDirectory;
+    std::string driverIdentity;
+    std::string driverDirectory;
+    int hitCount = 0;
+    int missCount = 0;
+};
+
+// 64-bit FNV-1a hash, printed as 16 hex digits
+std::string HashString(const std::string& text);
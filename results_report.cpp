@@ -0,0 +1,580 @@
+#include "results_report.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifndef SHADER_PERF_BUILD_TYPE
+#define SHADER_PERF_BUILD_TYPE "unknown"
+#endif
+#ifndef SHADER_PERF_GIT_REVISION
+#define SHADER_PERF_GIT_REVISION ""
+#endif
+
+namespace {
+
+// PerfStats fields as written to / read from the "stats" object
+struct StatsField {
+    const char* name;
+    double PerfStats::* value;
+};
+const StatsField statsFields[] = {
+    { "mean", &PerfStats::mean },
+    { "stddev", &PerfStats::stddev },
+    { "min", &PerfStats::min },
+    { "max", &PerfStats::max },
+    { "p50", &PerfStats::p50 },
+    { "p90", &PerfStats::p90 },
+    { "p99", &PerfStats::p99 },
+    { "p999", &PerfStats::p999 },
+    { "mad", &PerfStats::mad },
+    { "confidence", &PerfStats::confidence },
+    { "mean_ci_low", &PerfStats::meanCILow },
+    { "mean_ci_high", &PerfStats::meanCIHigh },
+    { "median_ci_low", &PerfStats::medianCILow },
+    { "median_ci_high", &PerfStats::medianCIHigh },
+};
+
+struct StatsCountField {
+    const char* name;
+    int PerfStats::* value;
+};
+const StatsCountField statsCountFields[] = {
+    { "total_samples", &PerfStats::totalSamples },
+    { "warmup_samples", &PerfStats::warmupSamples },
+    { "outlier_samples", &PerfStats::outlierSamples },
+    { "used_samples", &PerfStats::usedSamples },
+};
+
+std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string csvEscape(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) {
+        return text;
+    }
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+std::string formatNumber(double value) {
+    if (!std::isfinite(value)) {
+        return "null";
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", value);
+    return buf;
+}
+
+// Minimal JSON reader, enough for files written by WriteResultsJson
+struct JsonValue {
+    enum Type { Null, Bool, Number, String, Array, Object } type = Null;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    const JsonValue* get(const char* key) const {
+        for (const auto& member : object) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text(text) {}
+
+    bool parse(JsonValue& value) {
+        return parseValue(value) && (skipSpace(), pos == text.size());
+    }
+
+    size_t position() const { return pos; }
+
+private:
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseValue(JsonValue& value) {
+        skipSpace();
+        if (pos >= text.size()) return false;
+        char c = text[pos];
+        if (c == '{') return parseObject(value);
+        if (c == '[') return parseArray(value);
+        if (c == '"') {
+            value.type = JsonValue::String;
+            return parseString(value.string);
+        }
+        if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 5, "false") == 0) {
+            value.type = JsonValue::Bool;
+            value.number = text[pos] == 't' ? 1 : 0;
+            pos += text[pos] == 't' ? 4 : 5;
+            return true;
+        }
+        if (text.compare(pos, 4, "null") == 0) {
+            value.type = JsonValue::Null;
+            pos += 4;
+            return true;
+        }
+        const char* start = text.c_str() + pos;
+        char* end = nullptr;
+        value.number = std::strtod(start, &end);
+        if (end == start) return false;
+        value.type = JsonValue::Number;
+        pos += end - start;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        if (!consume('"')) return false;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) return false;
+            char e = text[pos++];
+            switch (e) {
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                    // Only the control characters jsonEscape produces
+                    if (pos + 4 > text.size()) return false;
+                    out += static_cast<char>(std::strtol(text.substr(pos, 4).c_str(), nullptr, 16));
+                    pos += 4;
+                    break;
+                default: out += e; break;
+            }
+        }
+        return consume('"');
+    }
+
+    bool parseArray(JsonValue& value) {
+        value.type = JsonValue::Array;
+        consume('[');
+        if (consume(']')) return true;
+        do {
+            value.array.emplace_back();
+            if (!parseValue(value.array.back())) return false;
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool parseObject(JsonValue& value) {
+        value.type = JsonValue::Object;
+        consume('{');
+        if (consume('}')) return true;
+        do {
+            std::string key;
+            skipSpace();
+            if (!parseString(key) || !consume(':')) return false;
+            value.object.emplace_back(key, JsonValue());
+            if (!parseValue(value.object.back().second)) return false;
+        } while (consume(','));
+        return consume('}');
+    }
+
+    const std::string& text;
+    size_t pos = 0;
+};
+
+// One-sided p-values of the Mann-Whitney U test (normal approximation with tie
+// and continuity correction) for "b tends to be larger than a" and the reverse
+void mannWhitney(const std::vector<double>& a, const std::vector<double>& b, double& pGreater, double& pLess) {
+    pGreater = pLess = 1.0;
+    const size_t n1 = a.size();
+    const size_t n2 = b.size();
+    if (n1 == 0 || n2 == 0) return;
+
+    std::vector<std::pair<double, int>> all;
+    all.reserve(n1 + n2);
+    for (double v : a) all.emplace_back(v, 0);
+    for (double v : b) all.emplace_back(v, 1);
+    std::sort(all.begin(), all.end());
+
+    // Average ranks over ties
+    const size_t n = all.size();
+    double rankSumB = 0;
+    double tieTerm = 0;
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        while (j < n && all[j].first == all[i].first) j++;
+        double rank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; k++) {
+            if (all[k].second == 1) rankSumB += rank;
+        }
+        double t = static_cast<double>(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    double u = rankSumB - n2 * (n2 + 1) / 2.0;
+    double meanU = n1 * n2 / 2.0;
+    double varU = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (static_cast<double>(n) * (n - 1)));
+    if (varU <= 0) return;
+    double sd = std::sqrt(varU);
+    pGreater = 0.5 * std::erfc(((u - meanU - 0.5) / sd) / std::sqrt(2.0));
+    pLess = 0.5 * std::erfc(((meanU - u - 0.5) / sd) / std::sqrt(2.0));
+}
+
+std::vector<double> steadyState(const ResultEntry& entry) {
+    size_t first = std::min(static_cast<size_t>(std::max(entry.stats.warmupSamples, 0)), entry.samples.size());
+    return std::vector<double>(entry.samples.begin() + first, entry.samples.end());
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return percentileSorted(values, 50.0);
+}
+
+} // namespace
+
+void ResultsReport::setMetadata(const std::string& key, const std::string& value) {
+    for (auto& item : metadata) {
+        if (item.first == key) {
+            item.second = value;
+            return;
+        }
+    }
+    metadata.emplace_back(key, value);
+}
+
+const ResultEntry* ResultsReport::find(const std::string& name, const std::string& variant, int width, int height) const {
+    for (const ResultEntry& entry : entries) {
+        if (entry.name == name && entry.variant == variant && entry.width == width && entry.height == height) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void AddBuildMetadata(ResultsReport& report) {
+#if defined(_MSC_VER)
+    report.setMetadata("compiler", "MSVC " + std::to_string(_MSC_VER));
+#elif defined(__clang__)
+    report.setMetadata("compiler", std::string("clang ") + __clang_version__);
+#elif defined(__GNUC__)
+    report.setMetadata("compiler", std::string("gcc ") + __VERSION__);
+#else
+    report.setMetadata("compiler", "unknown");
+#endif
+    report.setMetadata("build_type", SHADER_PERF_BUILD_TYPE);
+    report.setMetadata("git_revision", SHADER_PERF_GIT_REVISION);
+    report.setMetadata("build_date", std::string(__DATE__) + " " + __TIME__);
+}
+
+bool WriteResultsJson(const char* filename, const ResultsReport& report) {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "{\n  \"format\": \"shader_perf_results\",\n  \"version\": 1,\n  \"metadata\": {";
+    for (size_t i = 0; i < report.metadata.size(); i++) {
+        file << (i ? "," : "") << "\n    \"" << jsonEscape(report.metadata[i].first) << "\": \""
+             << jsonEscape(report.metadata[i].second) << "\"";
+    }
+    file << "\n  },\n  \"results\": [";
+
+    for (size_t i = 0; i < report.entries.size(); i++) {
+        const ResultEntry& entry = report.entries[i];
+        file << (i ? "," : "") << "\n    {\n"
+             << "      \"name\": \"" << jsonEscape(entry.name) << "\",\n"
+             << "      \"variant\": \"" << jsonEscape(entry.variant) << "\",\n"
+             << "      \"width\": " << entry.width << ",\n"
+             << "      \"height\": " << entry.height << ",\n"
+             << "      \"unit\": \"ms\",\n"
+             << "      \"stats\": {";
+        bool first = true;
+        for (const StatsCountField& field : statsCountFields) {
+            file << (first ? "" : ",") << "\n        \"" << field.name << "\": " << entry.stats.*field.value;
+            first = false;
+        }
+        for (const StatsField& field : statsFields) {
+            file << ",\n        \"" << field.name << "\": " << formatNumber(entry.stats.*field.value);
+        }
+        file << "\n      },\n      \"samples\": [";
+        for (size_t s = 0; s < entry.samples.size(); s++) {
+            file << (s ? (s % 10 ? ", " : ",\n        ") : "\n        ") << formatNumber(entry.samples[s]);
+        }
+        file << (entry.samples.empty() ? "]" : "\n      ]") << "\n    }";
+    }
+    file << "\n  ]\n}\n";
+
+    if (!file) {
+        std::cerr << "Failed to write " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool WriteResultsCsv(const char* filename, const ResultsReport& report) {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    for (const auto& item : report.metadata) {
+        file << "# " << csvEscape(item.first) << "," << csvEscape(item.second) << "\n";
+    }
+    file << "name,variant,width,height,sample,time_ms,warmup\n";
+    for (const ResultEntry& entry : report.entries) {
+        for (size_t s = 0; s < entry.samples.size(); s++) {
+            file << csvEscape(entry.name) << "," << csvEscape(entry.variant) << "," << entry.width << ","
+                 << entry.height << "," << s << "," << formatNumber(entry.samples[s]) << ","
+                 << (static_cast<int>(s) < entry.stats.warmupSamples ? 1 : 0) << "\n";
+        }
+    }
+
+    if (!file) {
+        std::cerr << "Failed to write " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool LoadResultsJson(const char* filename, ResultsReport& report) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open results file " << filename << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    JsonValue root;
+    JsonParser parser(text);
+    if (!parser.parse(root) || root.type != JsonValue::Object) {
+        std::cerr << "Failed to parse results file " << filename << " near offset " << parser.position() << std::endl;
+        return false;
+    }
+    const JsonValue* format = root.get("format");
+    const JsonValue* results = root.get("results");
+    if (!format || format->string != "shader_perf_results" || !results || results->type != JsonValue::Array) {
+        std::cerr << filename << " is not a shader_perf_test results file" << std::endl;
+        return false;
+    }
+
+    report = ResultsReport();
+    if (const JsonValue* metadata = root.get("metadata")) {
+        for (const auto& member : metadata->object) {
+            report.setMetadata(member.first, member.second.string);
+        }
+    }
+
+    for (const JsonValue& item : results->array) {
+        ResultEntry entry;
+        if (const JsonValue* v = item.get("name")) entry.name = v->string;
+        if (const JsonValue* v = item.get("variant")) entry.variant = v->string;
+        if (const JsonValue* v = item.get("width")) entry.width = static_cast<int>(v->number);
+        if (const JsonValue* v = item.get("height")) entry.height = static_cast<int>(v->number);
+        if (const JsonValue* stats = item.get("stats")) {
+            for (const StatsCountField& field : statsCountFields) {
+                if (const JsonValue* v = stats->get(field.name)) entry.stats.*field.value = static_cast<int>(v->number);
+            }
+            for (const StatsField& field : statsFields) {
+                if (const JsonValue* v = stats->get(field.name)) entry.stats.*field.value = v->number;
+            }
+        }
+        if (const JsonValue* samples = item.get("samples")) {
+            for (const JsonValue& v : samples->array) {
+                entry.samples.push_back(v.number);
+            }
+        }
+        report.entries.push_back(entry);
+    }
+    return true;
+}
+
+std::vector<RegressionRow> CompareResults(const ResultsReport& baseline, const ResultsReport& current,
+                                          const RegressionOptions& options) {
+    std::vector<RegressionRow> rows;
+
+    auto makeRow = [](const ResultEntry& entry) {
+        RegressionRow row;
+        row.name = entry.name;
+        row.variant = entry.variant;
+        row.width = entry.width;
+        row.height = entry.height;
+        return row;
+    };
+
+    for (const ResultEntry& cur : current.entries) {
+        RegressionRow row = makeRow(cur);
+        row.inCurrent = true;
+        std::vector<double> curSamples = steadyState(cur);
+        row.currentMedian = median(curSamples);
+
+        const ResultEntry* base = baseline.find(cur.name, cur.variant, cur.width, cur.height);
+        if (base) {
+            row.inBaseline = true;
+            std::vector<double> baseSamples = steadyState(*base);
+            row.baselineMedian = median(baseSamples);
+            if (row.baselineMedian > 0) {
+                row.changePercent = (row.currentMedian / row.baselineMedian - 1.0) * 100.0;
+            }
+
+            double pGreater, pLess;
+            mannWhitney(baseSamples, curSamples, pGreater, pLess);
+            row.pValue = row.changePercent >= 0 ? pGreater : pLess;
+            row.regression = row.changePercent > options.thresholdPercent && pGreater < options.significance;
+            row.improvement = row.changePercent < -options.thresholdPercent && pLess < options.significance;
+        }
+        rows.push_back(row);
+    }
+
+    for (const ResultEntry& base : baseline.entries) {
+        if (!current.find(base.name, base.variant, base.width, base.height)) {
+            RegressionRow row = makeRow(base);
+            row.inBaseline = true;
+            row.baselineMedian = median(steadyState(base));
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+int PrintRegressionReport(const std::vector<RegressionRow>& rows, const RegressionOptions& options) {
+    int regressions = 0;
+    std::cout << "\nBaseline Comparison (median, threshold " << options.thresholdPercent
+              << "%, significance " << options.significance << "):" << std::endl;
+    std::cout << "  Result                           Variant                Size        Base ms    Curr ms   Change   p-value  Verdict" << std::endl;
+    for (const RegressionRow& row : rows) {
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", row.width, row.height);
+        char line[300];
+        if (!row.inBaseline || !row.inCurrent) {
+            snprintf(line, sizeof(line), "  %-32s %-22s %-10s %9.3f %9.3f   %s", row.name.c_str(), row.variant.c_str(), size,
+                     row.baselineMedian, row.currentMedian, row.inBaseline ? "(missing from this run)" : "(new)");
+        } else {
+            const char* verdict = row.regression ? "REGRESSION" : (row.improvement ? "improved" : "ok");
+            snprintf(line, sizeof(line), "  %-32s %-22s %-10s %9.3f %9.3f %+7.1f%% %9.2g  %s", row.name.c_str(),
+                     row.variant.c_str(), size, row.baselineMedian, row.currentMedian, row.changePercent, row.pValue, verdict);
+        }
+        std::cout << line << std::endl;
+        if (row.regression) {
+            regressions++;
+        }
+    }
+
+    if (regressions > 0) {
+        std::cerr << "PERFORMANCE REGRESSION: " << regressions << " result(s) slower than baseline" << std::endl;
+    } else {
+        std::cout << "No significant regressions" << std::endl;
+    }
+    return regressions;
+}
+
+void PrintRunComparison(const std::vector<std::string>& labels, const std::vector<ResultsReport>& reports) {
+    auto metadata = [](const ResultsReport& report, const char* key) {
+        for (const auto& entry : report.metadata) {
+            if (entry.first == key) return entry.second;
+        }
+        return std::string();
+    };
+
+    std::cout << "\nRun Comparison (median ms, lower is better):" << std::endl;
+    for (size_t r = 0; r < reports.size(); r++) {
+        std::string renderer = metadata(reports[r], "gl_renderer");
+        std::string adapter = metadata(reports[r], "gpu_adapter");
+        std::cout << "  " << labels[r] << ": " << (renderer.empty() ? "(no results)" : renderer);
+        if (!adapter.empty() && adapter != renderer) {
+            std::cout << " [" << adapter << "]";
+        }
+        std::cout << std::endl;
+    }
+
+    // Every series in first-seen order across the runs
+    std::vector<const ResultEntry*> series;
+    for (const ResultsReport& report : reports) {
+        for (const ResultEntry& entry : report.entries) {
+            bool known = std::any_of(series.begin(), series.end(), [&](const ResultEntry* s) {
+                return s->name == entry.name && s->variant == entry.variant && s->width == entry.width &&
+                       s->height == entry.height;
+            });
+            if (!known) series.push_back(&entry);
+        }
+    }
+
+    std::cout << "  Result                           Variant                Size      ";
+    for (const std::string& label : labels) {
+        char column[32];
+        snprintf(column, sizeof(column), " %10s", label.c_str());
+        std::cout << column;
+    }
+    std::cout << "  Fastest" << std::endl;
+
+    for (const ResultEntry* entry : series) {
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", entry->width, entry->height);
+        char line[300];
+        snprintf(line, sizeof(line), "  %-32s %-22s %-10s", entry->name.c_str(), entry->variant.c_str(), size);
+        std::cout << line;
+
+        int fastest = -1;
+        int present = 0;
+        double best = 0;
+        for (size_t r = 0; r < reports.size(); r++) {
+            const ResultEntry* match = reports[r].find(entry->name, entry->variant, entry->width, entry->height);
+            char column[32];
+            if (match) {
+                snprintf(column, sizeof(column), " %10.3f", match->stats.p50);
+                present++;
+                if (fastest < 0 || match->stats.p50 < best) {
+                    fastest = static_cast<int>(r);
+                    best = match->stats.p50;
+                }
+            } else {
+                snprintf(column, sizeof(column), " %10s", "-");
+            }
+            std::cout << column;
+        }
+        std::cout << "  " << (present > 1 ? labels[fastest] : "") << std::endl;
+    }
+}
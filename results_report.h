@@ -0,0 +1,73 @@
+#pragma once
+
+#include "perf_stats.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// One timing series of a run: all raw samples plus their summary
+struct ResultEntry {
+    std::string name;      // e.g. "convert", "pipeline/depth3/latency"
+    std::string variant;   // shader variant active while measuring
+    int width = 0;
+    int height = 0;
+    std::vector<double> samples;  // ms, in measurement order (warm-up included)
+    PerfStats stats;
+};
+
+// Structured results of a run: environment metadata and every timing series.
+// Written as JSON (--json) or CSV (--csv) and read back as a baseline (--compare).
+struct ResultsReport {
+    std::vector<std::pair<std::string, std::string>> metadata;
+    std::vector<ResultEntry> entries;
+
+    // Replaces an existing key
+    void setMetadata(const std::string& key, const std::string& value);
+    const ResultEntry* find(const std::string& name, const std::string& variant, int width, int height) const;
+};
+
+// Compiler, build type and source revision of this executable
+void AddBuildMetadata(ResultsReport& report);
+
+bool WriteResultsJson(const char* filename, const ResultsReport& report);
+
+// One row per sample; metadata goes into leading "# key,value" comment lines
+bool WriteResultsCsv(const char* filename, const ResultsReport& report);
+
+// Load a file written by WriteResultsJson
+bool LoadResultsJson(const char* filename, ResultsReport& report);
+
+// Thresholds for flagging a regression against a baseline
+struct RegressionOptions {
+    double thresholdPercent = 5.0;  // minimum slowdown of the median
+    double significance = 0.01;     // one-sided Mann-Whitney U p-value
+};
+
+struct RegressionRow {
+    std::string name;
+    std::string variant;
+    int width = 0;
+    int height = 0;
+    bool inBaseline = false;
+    bool inCurrent = false;
+    double baselineMedian = 0;
+    double currentMedian = 0;
+    double changePercent = 0;  // positive = slower
+    double pValue = 1;         // probability of a slowdown this large by chance
+    bool regression = false;
+    bool improvement = false;
+};
+
+// Match series by name, variant and resolution, and test each pair. Warm-up
+// samples are dropped; a series regresses when its median is slower by more
+// than the threshold and the Mann-Whitney U test finds the slowdown significant.
+std::vector<RegressionRow> CompareResults(const ResultsReport& baseline, const ResultsReport& current,
+                                          const RegressionOptions& options);
+
+// Print the comparison table. Returns the number of regressions.
+int PrintRegressionReport(const std::vector<RegressionRow>& rows, const RegressionOptions& options);
+
+// Print the median of every series side by side, one column per run (e.g. the
+// same benchmark on each GPU), with the fastest run per series. Series are
+// matched by name, variant and resolution; runs that failed have an empty report.
+void PrintRunComparison(const std::vector<std::string>& labels, const std::vector<ResultsReport>& reports);
@@ -0,0 +1,87 @@
+#include "shader_variants.h"
+
+namespace {
+
+struct MatrixDef {
+    const char* name;
+    const char* define;  // nullptr = shader default
+    float rv, gu, gv, bu;
+};
+
+// Must match the constants in fragmentShaderSource
+const MatrixDef kMatrices[] = {
+    { "bt601",  nullptr,             1.403f,  0.344f,    0.714f,    1.770f  },
+    { "bt709",  "YUV_MATRIX_BT709",  1.5748f, 0.187324f, 0.468124f, 1.8556f },
+    { "bt2020", "YUV_MATRIX_BT2020", 1.4746f, 0.164553f, 0.571353f, 1.8814f },
+};
+
+} // namespace
+
+std::vector<ShaderVariant> BuildShaderVariantMatrix() {
+    std::vector<ShaderVariant> variants;
+
+    for (const MatrixDef& matrix : kMatrices) {
+        for (int limited = 0; limited <= 1; limited++) {
+            for (int clamp = 1; clamp >= 0; clamp--) {
+                ShaderVariant variant;
+                variant.name = std::string(matrix.name) + (limited ? "_limited" : "_full") +
+                               (clamp ? "_clamp" : "_noclamp");
+                if (matrix.define) {
+                    variant.defines.push_back(matrix.define);
+                }
+
+                variant.coeffs.rv = matrix.rv;
+                variant.coeffs.gu = matrix.gu;
+                variant.coeffs.gv = matrix.gv;
+                variant.coeffs.bu = matrix.bu;
+                if (limited) {
+                    variant.defines.push_back("YUV_LIMITED_RANGE");
+                    variant.coeffs.yOffset = 16.0f / 255.0f;
+                    variant.coeffs.yScale = 255.0f / 219.0f;
+                    variant.coeffs.uvOffset = 128.0f / 255.0f;
+                    variant.coeffs.uvScale = 255.0f / 224.0f;
+                }
+
+                // The render target is UNORM8, so stores clamp anyway: no-clamp
+                // variants must produce the same image, only the ALU cost differs
+                if (!clamp) {
+                    variant.defines.push_back("YUV_NO_CLAMP");
+                }
+                variants.push_back(variant);
+            }
+        }
+    }
+
+    return variants;
+}
+
+bool FindShaderVariant(const std::string& name, ShaderVariant& variant) {
+    for (const ShaderVariant& candidate : BuildShaderVariantMatrix()) {
+        if (candidate.name == name) {
+            variant = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string InjectShaderDefines(const char* source, const std::vector<std::string>& defines) {
+    std::string result = source;
+    if (defines.empty()) return result;
+
+    std::string block;
+    for (const std::string& define : defines) {
+        // "NAME VALUE" defines keep their value, plain names become 1
+        block += "#define " + define + (define.find(' ') == std::string::npos ? " 1\n" : "\n");
+    }
+
+    // #version must stay the first line, so insert after it
+    size_t insertAt = 0;
+    if (result.compare(0, 8, "#version") == 0) {
+        size_t eol = result.find('\n');
+        insertAt = (eol == std::string::npos) ? result.size() : eol + 1;
+        if (eol == std::string::npos) block = "\n" + block;
+    }
+    result.insert(insertAt, block);
+    return result;
+}
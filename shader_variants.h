@@ -0,0 +1,23 @@
+#pragma once
+
+#include "cpu_converter.h"
+#include <string>
+#include <vector>
+
+// One compile-time specialization of fragmentShaderSource
+struct ShaderVariant {
+    std::string name;                  // e.g. "bt709_limited_clamp"
+    std::vector<std::string> defines;  // injected as "#define NAME 1"
+    YuvToRgbCoefficients coeffs;       // matching parameters for the CPU reference
+};
+
+// All combinations of matrix (BT.601/709/2020) x range (full/limited) x clamp (on/off).
+// The first entry is the default variant, identical to the undecorated shader.
+std::vector<ShaderVariant> BuildShaderVariantMatrix();
+
+// Look up a variant by name
+bool FindShaderVariant(const std::string& name, ShaderVariant& variant);
+
+// Insert #define lines right after the #version directive of a GLSL source.
+// "NAME" becomes "#define NAME 1", "NAME VALUE" becomes "#define NAME VALUE".
+std::string InjectShaderDefines(const char* source, const std::vector<std::string>& defines);
@@ -10,25 +10,376 @@ void main() {
     TexCoord = aTexCoord;
 })";
 
+// Batched conversion: instance i draws the full-screen quad into tile i of an
+// atlas (tilesPerRow tiles per row, each tileScale NDC units) and samples layer i
+const char* batchVertexShaderSource = R"(#version 300 es
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aTexCoord;
+uniform int tilesPerRow;
+uniform vec2 tileScale;
+out vec2 TexCoord;
+flat out int Layer;
+
+void main() {
+    vec2 tile = vec2(float(gl_InstanceID % tilesPerRow), float(gl_InstanceID / tilesPerRow));
+    vec2 unit = aPos.xy * 0.5 + 0.5;
+    gl_Position = vec4((tile + unit) * tileScale - 1.0, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    Layer = gl_InstanceID;
+})";
+
+// Variants are specialized at compile time with #defines injected after #version:
+//   YUV_MATRIX_BT709 / YUV_MATRIX_BT2020  color matrix (default: BT.601)
+//   YUV_LIMITED_RANGE                     16-235 / 16-240 input (default: full range)
+//   YUV_NO_CLAMP                          skip the explicit clamp
+// and for the input/output format pairs (pixel_formats.h):
+//   INPUT_P010                            16-bit planes with 10-bit samples in the high bits
+//   INPUT_I420                            separate U and V planes instead of interleaved UV
+//   OUTPUT_BGRA                           B and R swapped in the RGBA8 target
+//   OUTPUT_PLANAR_RGB                     R, G and B to three single-channel targets
+// and for batched conversion (batchVertexShaderSource):
+//   INPUT_TEXTURE_ARRAY                   Y/UV are texture arrays, one layer per frame
+// and for the chroma sampling strategies (chroma_sampling.h, NV12 input only):
+//   CHROMA_TEXEL_FETCH                    texelFetch luma and 4 chroma texels, bilinear in ALU
+//   CHROMA_GATHER                         texelFetch luma, one textureGather per chroma
+//                                         channel (needs the source compiled as GLSL ES 3.10)
 const char* fragmentShaderSource = R"(#version 300 es
 precision highp float;
+#if defined(CHROMA_TEXEL_FETCH) || defined(CHROMA_GATHER)
+precision highp int;
+#endif
+#ifdef INPUT_TEXTURE_ARRAY
+precision highp sampler2DArray;
+uniform sampler2DArray yTexture;
+uniform sampler2DArray uvTexture;
+flat in int Layer;
+#else
 uniform sampler2D yTexture;
+#ifdef INPUT_I420
+uniform sampler2D uTexture;
+uniform sampler2D vTexture;
+#else
 uniform sampler2D uvTexture;
+#endif
+#endif
 in vec2 TexCoord;
+#ifdef OUTPUT_PLANAR_RGB
+layout(location = 0) out float FragR;
+layout(location = 1) out float FragG;
+layout(location = 2) out float FragB;
+#else
 out vec4 FragColor;
+#endif
+
+#if defined(YUV_MATRIX_BT709)
+const float RV = 1.5748;
+const float GU = 0.187324;
+const float GV = 0.468124;
+const float BU = 1.8556;
+#elif defined(YUV_MATRIX_BT2020)
+const float RV = 1.4746;
+const float GU = 0.164553;
+const float GV = 0.571353;
+const float BU = 1.8814;
+#else
+const float RV = 1.403;
+const float GU = 0.344;
+const float GV = 0.714;
+const float BU = 1.770;
+#endif
 
 void main() {
-    float y = texture(yTexture, TexCoord).r;
-    vec2 uv = texture(uvTexture, TexCoord).rg - vec2(0.5, 0.5);
+#ifdef INPUT_TEXTURE_ARRAY
+    vec3 coord = vec3(TexCoord, float(Layer));
+#else
+    vec2 coord = TexCoord;
+#endif
+#if defined(CHROMA_TEXEL_FETCH) || defined(CHROMA_GATHER)
+    // Integer addressing: the fragment's own luma texel, and the GL_LINEAR
+    // chroma footprint and weights computed here instead of by the sampler
+    ivec2 pos = ivec2(gl_FragCoord.xy);
+    float y = texelFetch(yTexture, pos, 0).r;
+    ivec2 chromaSize = textureSize(uvTexture, 0);
+    vec2 chromaCoord = (vec2(pos) + 0.5) * vec2(chromaSize) / vec2(textureSize(yTexture, 0)) - 0.5;
+    vec2 cell = floor(chromaCoord);
+    vec2 f = chromaCoord - cell;
+#ifdef CHROMA_GATHER
+    // At the corner shared by the four texels, gather returns (i0,j1), (i1,j1),
+    // (i1,j0), (i0,j0) in x, y, z, w; CLAMP_TO_EDGE handles the borders
+    vec2 gatherCoord = (cell + 1.0) / vec2(chromaSize);
+    vec4 u4 = textureGather(uvTexture, gatherCoord, 0);
+    vec4 v4 = textureGather(uvTexture, gatherCoord, 1);
+    vec2 c00 = vec2(u4.w, v4.w);
+    vec2 c10 = vec2(u4.z, v4.z);
+    vec2 c01 = vec2(u4.x, v4.x);
+    vec2 c11 = vec2(u4.y, v4.y);
+#else
+    ivec2 t0 = clamp(ivec2(cell), ivec2(0), chromaSize - 1);
+    ivec2 t1 = clamp(ivec2(cell) + 1, ivec2(0), chromaSize - 1);
+    vec2 c00 = texelFetch(uvTexture, t0, 0).rg;
+    vec2 c10 = texelFetch(uvTexture, ivec2(t1.x, t0.y), 0).rg;
+    vec2 c01 = texelFetch(uvTexture, ivec2(t0.x, t1.y), 0).rg;
+    vec2 c11 = texelFetch(uvTexture, t1, 0).rg;
+#endif
+    vec2 uv = mix(mix(c00, c10, f.x), mix(c01, c11, f.x), f.y);
+#else
+    float y = texture(yTexture, coord).r;
+#ifdef INPUT_I420
+    vec2 uv = vec2(texture(uTexture, coord).r, texture(vTexture, coord).r);
+#else
+    vec2 uv = texture(uvTexture, coord).rg;
+#endif
+#endif
+
+#ifdef INPUT_P010
+    // UNORM16 holds value10 << 6: rescale so 1023 maps to 1.0
+    y *= 65535.0 / 65472.0;
+    uv *= 65535.0 / 65472.0;
+#endif
+
+#ifdef YUV_LIMITED_RANGE
+    y = (y - 16.0 / 255.0) * (255.0 / 219.0);
+    uv = (uv - vec2(128.0 / 255.0)) * (255.0 / 224.0);
+#else
+    uv -= vec2(0.5, 0.5);
+#endif
     
     // YUV to RGB conversion
     vec3 rgb;
-    rgb.r = y + 1.403 * uv.y;
-    rgb.g = y - 0.344 * uv.x - 0.714 * uv.y;
-    rgb.b = y + 1.770 * uv.x;
+    rgb.r = y + RV * uv.y;
+    rgb.g = y - GU * uv.x - GV * uv.y;
+    rgb.b = y + BU * uv.x;
     
+#ifndef YUV_NO_CLAMP
     // Ensure values are in valid range
     rgb = clamp(rgb, 0.0, 1.0);
+#endif
     
+#if defined(OUTPUT_PLANAR_RGB)
+    FragR = rgb.r;
+    FragG = rgb.g;
+    FragB = rgb.b;
+#elif defined(OUTPUT_BGRA)
+    FragColor = vec4(rgb.bgr, 1.0);
+#else
     FragColor = vec4(rgb, 1.0);
+#endif
+})";
+
+// Compute-shader path (OpenGL ES 3.1), same color math as fragmentShaderSource.
+// Specialized with injected defines: LOCAL_SIZE_X/LOCAL_SIZE_Y (workgroup size),
+// PIXELS_X/PIXELS_Y (output pixels per invocation) and the variant defines above.
+// With one pixel per invocation chroma goes through the bilinear sampler. Blocks
+// of several pixels fetch the chroma neighbourhood they share once with
+// texelFetch and apply the GL_LINEAR weights of each pixel in ALU.
+const char* computeShaderSource = R"(#version 310 es
+precision highp float;
+precision highp int;
+layout(local_size_x = LOCAL_SIZE_X, local_size_y = LOCAL_SIZE_Y) in;
+uniform highp sampler2D yTexture;
+uniform highp sampler2D uvTexture;
+layout(rgba8, binding = 0) writeonly uniform highp image2D outputImage;
+
+#if defined(YUV_MATRIX_BT709)
+const float RV = 1.5748;
+const float GU = 0.187324;
+const float GV = 0.468124;
+const float BU = 1.8556;
+#elif defined(YUV_MATRIX_BT2020)
+const float RV = 1.4746;
+const float GU = 0.164553;
+const float GV = 0.571353;
+const float BU = 1.8814;
+#else
+const float RV = 1.403;
+const float GU = 0.344;
+const float GV = 0.714;
+const float BU = 1.770;
+#endif
+
+// Chroma texels covered by a block of PIXELS_X x PIXELS_Y output pixels
+const int CHROMA_COLS = PIXELS_X / 2 + 2;
+const int CHROMA_ROWS = PIXELS_Y / 2 + 2;
+
+vec4 yuvToRgba(float y, vec2 uv) {
+#ifdef YUV_LIMITED_RANGE
+    y = (y - 16.0 / 255.0) * (255.0 / 219.0);
+    uv = (uv - vec2(128.0 / 255.0)) * (255.0 / 224.0);
+#else
+    uv -= vec2(0.5, 0.5);
+#endif
+    vec3 rgb;
+    rgb.r = y + RV * uv.y;
+    rgb.g = y - GU * uv.x - GV * uv.y;
+    rgb.b = y + BU * uv.x;
+#ifndef YUV_NO_CLAMP
+    rgb = clamp(rgb, 0.0, 1.0);
+#endif
+    return vec4(rgb, 1.0);
+}
+
+void main() {
+    ivec2 size = imageSize(outputImage);
+    ivec2 origin = ivec2(gl_GlobalInvocationID.xy) * ivec2(PIXELS_X, PIXELS_Y);
+    if (any(greaterThanEqual(origin, size))) {
+        return;
+    }
+
+#if PIXELS_X == 1 && PIXELS_Y == 1
+    float y = texelFetch(yTexture, origin, 0).r;
+    vec2 uv = textureLod(uvTexture, (vec2(origin) + 0.5) / vec2(size), 0.0).rg;
+    imageStore(outputImage, origin, yuvToRgba(y, uv));
+#else
+    ivec2 chromaSize = textureSize(uvTexture, 0);
+    vec2 chromaScale = vec2(chromaSize) / vec2(size);
+    ivec2 base = ivec2(floor((vec2(origin) + 0.5) * chromaScale - 0.5));
+
+    vec2 chroma[CHROMA_ROWS][CHROMA_COLS];
+    for (int j = 0; j < CHROMA_ROWS; j++) {
+        for (int i = 0; i < CHROMA_COLS; i++) {
+            ivec2 texel = clamp(base + ivec2(i, j), ivec2(0), chromaSize - 1);
+            chroma[j][i] = texelFetch(uvTexture, texel, 0).rg;
+        }
+    }
+
+    for (int py = 0; py < PIXELS_Y; py++) {
+        for (int px = 0; px < PIXELS_X; px++) {
+            ivec2 pos = origin + ivec2(px, py);
+            if (any(greaterThanEqual(pos, size))) {
+                continue;
+            }
+            vec2 coord = (vec2(pos) + 0.5) * chromaScale - 0.5;
+            vec2 cell = floor(coord);
+            vec2 f = coord - cell;
+            ivec2 k = ivec2(cell) - base;
+            vec2 top = mix(chroma[k.y][k.x], chroma[k.y][k.x + 1], f.x);
+            vec2 bottom = mix(chroma[k.y + 1][k.x], chroma[k.y + 1][k.x + 1], f.x);
+            float y = texelFetch(yTexture, pos, 0).r;
+            imageStore(outputImage, pos, yuvToRgba(y, mix(top, bottom, f.y)));
+        }
+    }
+#endif
+})";
+
+// Multi-pixel fragment path, pass 1: rendered at quarter resolution, each
+// fragment converts a 2x2 block of output pixels into four render targets
+// (top-left, top-right, bottom-left, bottom-right). Luma for the block is one
+// textureGather when USE_TEXTURE_GATHER is defined (the source is then compiled
+// as GLSL ES 3.10), otherwise four texelFetch. The four GL_LINEAR chroma
+// footprints of the block lie in one 3x3 chroma neighbourhood, which is fetched
+// once; each pixel's bilinear weights are applied in ALU, as in the compute
+// block path. Variant defines apply. highp int: texel coordinates exceed the
+// mediump range at 4K.
+const char* blockFragmentShaderSource = R"(#version 300 es
+precision highp float;
+precision highp int;
+uniform sampler2D yTexture;
+uniform sampler2D uvTexture;
+layout(location = 0) out vec4 BlockTL;
+layout(location = 1) out vec4 BlockTR;
+layout(location = 2) out vec4 BlockBL;
+layout(location = 3) out vec4 BlockBR;
+
+#if defined(YUV_MATRIX_BT709)
+const float RV = 1.5748;
+const float GU = 0.187324;
+const float GV = 0.468124;
+const float BU = 1.8556;
+#elif defined(YUV_MATRIX_BT2020)
+const float RV = 1.4746;
+const float GU = 0.164553;
+const float GV = 0.571353;
+const float BU = 1.8814;
+#else
+const float RV = 1.403;
+const float GU = 0.344;
+const float GV = 0.714;
+const float BU = 1.770;
+#endif
+
+vec4 yuvToRgba(float y, vec2 uv) {
+#ifdef YUV_LIMITED_RANGE
+    y = (y - 16.0 / 255.0) * (255.0 / 219.0);
+    uv = (uv - vec2(128.0 / 255.0)) * (255.0 / 224.0);
+#else
+    uv -= vec2(0.5, 0.5);
+#endif
+    vec3 rgb;
+    rgb.r = y + RV * uv.y;
+    rgb.g = y - GU * uv.x - GV * uv.y;
+    rgb.b = y + BU * uv.x;
+#ifndef YUV_NO_CLAMP
+    rgb = clamp(rgb, 0.0, 1.0);
+#endif
+    return vec4(rgb, 1.0);
+}
+
+// GL_LINEAR chroma of output pixel pos from the 3x3 texels starting at base
+vec2 chromaAt(vec2 chroma[9], ivec2 pos, ivec2 base, vec2 chromaScale) {
+    vec2 coord = (vec2(pos) + 0.5) * chromaScale - 0.5;
+    vec2 cell = floor(coord);
+    vec2 f = coord - cell;
+    ivec2 k = min(ivec2(cell) - base, ivec2(1));
+    int i = k.y * 3 + k.x;
+    vec2 top = mix(chroma[i], chroma[i + 1], f.x);
+    vec2 bottom = mix(chroma[i + 3], chroma[i + 4], f.x);
+    return mix(top, bottom, f.y);
+}
+
+void main() {
+    ivec2 size = textureSize(yTexture, 0);
+    vec2 sizeF = vec2(size);
+    ivec2 origin = ivec2(gl_FragCoord.xy) * 2;
+
+#ifdef USE_TEXTURE_GATHER
+    // Sampling at the shared corner returns (BL, BR, TR, TL) in x, y, z, w
+    vec4 luma = textureGather(yTexture, (vec2(origin) + 1.0) / sizeF, 0);
+    float yTL = luma.w;
+    float yTR = luma.z;
+    float yBL = luma.x;
+    float yBR = luma.y;
+#else
+    ivec2 last = size - 1;
+    float yTL = texelFetch(yTexture, origin, 0).r;
+    float yTR = texelFetch(yTexture, min(origin + ivec2(1, 0), last), 0).r;
+    float yBL = texelFetch(yTexture, min(origin + ivec2(0, 1), last), 0).r;
+    float yBR = texelFetch(yTexture, min(origin + ivec2(1, 1), last), 0).r;
+#endif
+
+    ivec2 chromaSize = textureSize(uvTexture, 0);
+    vec2 chromaScale = vec2(chromaSize) / sizeF;
+    ivec2 base = ivec2(floor((vec2(origin) + 0.5) * chromaScale - 0.5));
+    vec2 chroma[9];
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 3; i++) {
+            ivec2 texel = clamp(base + ivec2(i, j), ivec2(0), chromaSize - 1);
+            chroma[j * 3 + i] = texelFetch(uvTexture, texel, 0).rg;
+        }
+    }
+
+    BlockTL = yuvToRgba(yTL, chromaAt(chroma, origin, base, chromaScale));
+    BlockTR = yuvToRgba(yTR, chromaAt(chroma, origin + ivec2(1, 0), base, chromaScale));
+    BlockBL = yuvToRgba(yBL, chromaAt(chroma, origin + ivec2(0, 1), base, chromaScale));
+    BlockBR = yuvToRgba(yBR, chromaAt(chroma, origin + ivec2(1, 1), base, chromaScale));
+})";
+
+// Multi-pixel fragment path, pass 2: full-resolution resolve that interleaves
+// the four quarter-resolution targets back into one image
+const char* resolveFragmentShaderSource = R"(#version 300 es
+precision highp float;
+uniform sampler2D blockTL;
+uniform sampler2D blockTR;
+uniform sampler2D blockBL;
+uniform sampler2D blockBR;
+out vec4 FragColor;
+
+void main() {
+    ivec2 pos = ivec2(gl_FragCoord.xy);
+    ivec2 block = pos / 2;
+    bool right = (pos.x & 1) == 1;
+    if ((pos.y & 1) == 0) {
+        FragColor = right ? texelFetch(blockTR, block, 0) : texelFetch(blockTL, block, 0);
+    } else {
+        FragColor = right ? texelFetch(blockBR, block, 0) : texelFetch(blockBL, block, 0);
+    }
 })"; 
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include "test_patterns.h"
+#include "texture_utils.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace {
+
+const double kTwoPi = 6.283185307179586;
+
+struct PatternInfo {
+    TestPattern pattern;
+    const char* name;
+};
+
+const PatternInfo kPatterns[] = {
+    { TestPattern::Gradient, "gradient" },
+    { TestPattern::Noise, "noise" },
+    { TestPattern::ZonePlate, "zoneplate" },
+    { TestPattern::ColorBars, "bars" },
+    { TestPattern::Moving, "moving" },
+};
+
+// Frame being generated. Work is split by chroma row: chroma row cy owns luma
+// rows 2*cy and 2*cy + 1, so bands never share an output row.
+struct FrameTarget {
+    uint8_t* yPlane;
+    uint8_t* uvPlane;
+    int width;
+    int height;
+    int chromaWidth;
+    int chromaHeight;
+
+    uint8_t* lumaRow(int y) const { return yPlane + static_cast<size_t>(y) * width; }
+    uint8_t* chromaRow(int cy) const { return uvPlane + static_cast<size_t>(cy) * chromaWidth * 2; }
+};
+
+void runRows(const FrameTarget& frame, ThreadPool* pool, const std::function<void(int, int)>& band) {
+    if (pool) {
+        pool->parallelFor(frame.chromaHeight, band);
+    } else {
+        band(0, frame.chromaHeight);
+    }
+}
+
+// Luma rows 2*cy and 2*cy + 1 that exist for chroma row cy
+template <typename Fn>
+void forLumaRows(const FrameTarget& frame, int cy, Fn&& fn) {
+    for (int y = cy * 2; y < std::min(cy * 2 + 2, frame.height); y++) {
+        fn(y, frame.lumaRow(y));
+    }
+}
+
+// Sine/cosine chroma of the gradient pattern, one entry per chroma column/row.
+// Same expressions as the original per-sample code, so the output is unchanged.
+void buildGradientChromaTables(const FrameTarget& frame, std::vector<uint8_t>& uTable, std::vector<uint8_t>& vTable) {
+    uTable.resize(frame.chromaWidth);
+    vTable.resize(frame.chromaHeight);
+    for (int x = 0; x < frame.chromaWidth; x++) {
+        uTable[x] = (uint8_t)(128 + 127 * sin(x * 6.28 / frame.chromaWidth));
+    }
+    for (int y = 0; y < frame.chromaHeight; y++) {
+        vTable[y] = (uint8_t)(128 + 127 * cos(y * 6.28 / frame.chromaHeight));
+    }
+}
+
+void generateGradient(const FrameTarget& frame, ThreadPool* pool) {
+    std::vector<uint8_t> uTable, vTable;
+    buildGradientChromaTables(frame, uTable, vTable);
+
+    runRows(frame, pool, [&](int begin, int end) {
+        for (int cy = begin; cy < end; cy++) {
+            forLumaRows(frame, cy, [&](int y, uint8_t* row) {
+                memset(row, (y * 255) / frame.height, frame.width);
+            });
+            uint8_t* uv = frame.chromaRow(cy);
+            const uint8_t v = vTable[cy];
+            for (int x = 0; x < frame.chromaWidth; x++) {
+                uv[x * 2] = uTable[x];
+                uv[x * 2 + 1] = v;
+            }
+        }
+    });
+}
+
+// Scrolling XOR texture with the gradient chroma shifted by the frame index
+void generateMoving(const FrameTarget& frame, int frameIndex, ThreadPool* pool) {
+    std::vector<uint8_t> uTable, vTable;
+    buildGradientChromaTables(frame, uTable, vTable);
+    const int dx = frameIndex * 4;
+    const int dy = frameIndex * 2;
+    const int chromaShift = frameIndex % frame.chromaWidth;
+
+    runRows(frame, pool, [&](int begin, int end) {
+        for (int cy = begin; cy < end; cy++) {
+            forLumaRows(frame, cy, [&](int y, uint8_t* row) {
+                const int rowKey = y + dy;
+                for (int x = 0; x < frame.width; x++) {
+                    row[x] = static_cast<uint8_t>((x + dx) ^ rowKey);
+                }
+            });
+            uint8_t* uv = frame.chromaRow(cy);
+            const uint8_t v = vTable[(cy + frameIndex) % frame.chromaHeight];
+            for (int x = 0; x < frame.chromaWidth; x++) {
+                int ux = x + chromaShift;
+                uv[x * 2] = uTable[ux < frame.chromaWidth ? ux : ux - frame.chromaWidth];
+                uv[x * 2 + 1] = v;
+            }
+        }
+    });
+}
+
+inline uint32_t mixBits(uint32_t v) {
+    v ^= v >> 16;
+    v *= 0x7feb352du;
+    v ^= v >> 15;
+    v *= 0x846ca68bu;
+    v ^= v >> 16;
+    return v ? v : 1;
+}
+
+// xorshift32 stream seeded per row, so bands are independent and reproducible
+void fillNoiseRow(uint8_t* row, int count, uint32_t seed) {
+    uint32_t state = mixBits(seed);
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        memcpy(row + x, &state, 4);
+    }
+    for (; x < count; x++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        row[x] = static_cast<uint8_t>(state);
+    }
+}
+
+void generateNoise(const FrameTarget& frame, int frameIndex, ThreadPool* pool) {
+    const uint32_t frameSeed = static_cast<uint32_t>(frameIndex) * 0x9e3779b9u;
+    runRows(frame, pool, [&](int begin, int end) {
+        for (int cy = begin; cy < end; cy++) {
+            forLumaRows(frame, cy, [&](int y, uint8_t* row) {
+                fillNoiseRow(row, frame.width, frameSeed ^ (static_cast<uint32_t>(y) * 2654435761u));
+            });
+            fillNoiseRow(frame.chromaRow(cy), frame.chromaWidth * 2,
+                         frameSeed ^ (static_cast<uint32_t>(cy) * 2246822519u) ^ 0x5bd1e995u);
+        }
+    });
+}
+
+// cos(k * r^2) with k chosen so the local frequency reaches Nyquist at the
+// left and right edges. The phase comes from integer r^2 and a 1024-entry table.
+void generateZonePlate(const FrameTarget& frame, ThreadPool* pool) {
+    uint8_t cosTable[1024];
+    for (int i = 0; i < 1024; i++) {
+        cosTable[i] = static_cast<uint8_t>(std::lrint(127.5 + 127.5 * std::cos(i * kTwoPi / 1024.0)));
+    }
+    // Coordinates are doubled (pixel centers at odd values), so r^2 is 4x:
+    // table index = r^2 * 512 / width / 4, in 16.16 fixed point
+    const uint64_t step = (static_cast<uint64_t>(128) << 16) / static_cast<uint64_t>(frame.width);
+    auto index = [&](int64_t dx, int64_t dy) {
+        return static_cast<int>((static_cast<uint64_t>(dx * dx + dy * dy) * step >> 16) & 1023);
+    };
+
+    runRows(frame, pool, [&](int begin, int end) {
+        for (int cy = begin; cy < end; cy++) {
+            forLumaRows(frame, cy, [&](int y, uint8_t* row) {
+                const int64_t dy = 2 * y + 1 - frame.height;
+                for (int x = 0; x < frame.width; x++) {
+                    row[x] = cosTable[index(2 * x + 1 - frame.width, dy)];
+                }
+            });
+            // Chroma samples sit at the center of their 2x2 luma block
+            uint8_t* uv = frame.chromaRow(cy);
+            const int64_t dy = 4 * cy + 2 - frame.height;
+            for (int x = 0; x < frame.chromaWidth; x++) {
+                int i = index(4 * x + 2 - frame.width, dy);
+                uv[x * 2] = cosTable[i];
+                uv[x * 2 + 1] = cosTable[(i + 256) & 1023];
+            }
+        }
+    });
+}
+
+struct Yuv {
+    uint8_t y, u, v;
+};
+
+// Full-range BT.601, the inverse of the default conversion shader
+Yuv rgbToYuv(int r, int g, int b) {
+    double y = 0.299 * r + 0.587 * g + 0.114 * b;
+    auto clampByte = [](double value) { return static_cast<uint8_t>(std::clamp(std::lrint(value), 0L, 255L)); };
+    return { clampByte(y), clampByte(128 + (b - y) / 1.770), clampByte(128 + (r - y) / 1.403) };
+}
+
+// SMPTE-style bars: seven 75% bars, the reversed castellation strip, and a
+// bottom strip with -I, 100% white, +Q, black and a +4% PLUGE step
+void generateColorBars(const FrameTarget& frame, ThreadPool* pool) {
+    const Yuv top[7] = { rgbToYuv(191, 191, 191), rgbToYuv(191, 191, 0), rgbToYuv(0, 191, 191), rgbToYuv(0, 191, 0),
+                         rgbToYuv(191, 0, 191), rgbToYuv(191, 0, 0), rgbToYuv(0, 0, 191) };
+    const Yuv black = rgbToYuv(0, 0, 0);
+    const Yuv middle[7] = { top[6], black, top[4], black, top[2], black, top[0] };
+    // Bottom strip cells in 1/28ths of the width
+    struct Cell { int end28; Yuv color; };
+    const Cell bottom[] = { { 5, rgbToYuv(0, 33, 76) }, { 10, rgbToYuv(255, 255, 255) }, { 15, rgbToYuv(50, 0, 106) },
+                            { 22, black }, { 23, rgbToYuv(10, 10, 10) }, { 28, black } };
+
+    auto colorAt = [&](int band, int x) -> Yuv {
+        if (band == 0) return top[std::min(x * 7 / frame.width, 6)];
+        if (band == 1) return middle[std::min(x * 7 / frame.width, 6)];
+        int cell28 = x * 28 / frame.width;
+        for (const Cell& cell : bottom) {
+            if (cell28 < cell.end28) return cell.color;
+        }
+        return black;
+    };
+
+    // One prebuilt luma and chroma row per band; rows are then plain copies
+    std::vector<uint8_t> lumaRows[3], chromaRows[3];
+    for (int band = 0; band < 3; band++) {
+        lumaRows[band].resize(frame.width);
+        chromaRows[band].resize(static_cast<size_t>(frame.chromaWidth) * 2);
+        for (int x = 0; x < frame.width; x++) {
+            lumaRows[band][x] = colorAt(band, x).y;
+        }
+        for (int x = 0; x < frame.chromaWidth; x++) {
+            Yuv c = colorAt(band, std::min(x * 2, frame.width - 1));
+            chromaRows[band][x * 2] = c.u;
+            chromaRows[band][x * 2 + 1] = c.v;
+        }
+    }
+    auto bandOf = [&](int y) { return y < frame.height * 2 / 3 ? 0 : (y < frame.height * 3 / 4 ? 1 : 2); };
+
+    runRows(frame, pool, [&](int begin, int end) {
+        for (int cy = begin; cy < end; cy++) {
+            forLumaRows(frame, cy, [&](int y, uint8_t* row) {
+                memcpy(row, lumaRows[bandOf(y)].data(), frame.width);
+            });
+            memcpy(frame.chromaRow(cy), chromaRows[bandOf(cy * 2)].data(), chromaRows[0].size());
+        }
+    });
+}
+
+} // namespace
+
+const char* TestPatternName(TestPattern pattern) {
+    for (const PatternInfo& info : kPatterns) {
+        if (info.pattern == pattern) return info.name;
+    }
+    return "unknown";
+}
+
+bool ParseTestPattern(const std::string& name, TestPattern& pattern) {
+    for (const PatternInfo& info : kPatterns) {
+        if (name == info.name) {
+            pattern = info.pattern;
+            return true;
+        }
+    }
+    return false;
+}
+
+void GenerateNV12Pattern(TestPattern pattern, uint8_t* yPlane, uint8_t* uvPlane, int width, int height,
+                         int frameIndex, ThreadPool* pool) {
+    FrameTarget frame = { yPlane, uvPlane, width, height, NV12ChromaWidth(width), NV12ChromaHeight(height) };
+    switch (pattern) {
+        case TestPattern::Gradient: generateGradient(frame, pool); break;
+        case TestPattern::Noise: generateNoise(frame, frameIndex, pool); break;
+        case TestPattern::ZonePlate: generateZonePlate(frame, pool); break;
+        case TestPattern::ColorBars: generateColorBars(frame, pool); break;
+        case TestPattern::Moving: generateMoving(frame, frameIndex, pool); break;
+    }
+}
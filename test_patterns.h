@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class ThreadPool;
+
+// Synthetic NV12 content. Each pattern stresses the sampler and caches differently.
+enum class TestPattern {
+    Gradient,   // vertical luma ramp, slow sine chroma (the original test pattern)
+    Noise,      // uniform random luma and chroma: no spatial coherence at all
+    ZonePlate,  // circular chirp up to Nyquist at the edges: every spatial frequency
+    ColorBars,  // 75% SMPTE-style bars: flat areas with hard chroma edges
+    Moving,     // scrolling XOR texture and chroma, different every frame
+};
+
+const char* TestPatternName(TestPattern pattern);
+bool ParseTestPattern(const std::string& name, TestPattern& pattern);
+
+// Fill an NV12 frame (uvPlane: NV12ChromaWidth x NV12ChromaHeight interleaved
+// samples). frameIndex animates Moving and reseeds Noise; the other patterns are
+// static. Rows are split across pool when given. Per-sample work is table
+// lookups and integer math only, in loops the compiler can vectorize.
+void GenerateNV12Pattern(TestPattern pattern, uint8_t* yPlane, uint8_t* uvPlane, int width, int height,
+                         int frameIndex = 0, ThreadPool* pool = nullptr);
@@ -1,11 +1,49 @@
 #pragma once
 
 #include <cstdint>  // for uint8_t
+#include <cstddef>  // for size_t
+
+#ifdef _WIN32
 #include <windows.h> // for BITMAPFILEHEADER, BITMAPINFOHEADER
-#include <cstdio>   // for FILE operations
+#else
+// BMP headers with the same layout as the Win32 definitions
+#pragma pack(push, 2)
+struct BITMAPFILEHEADER {
+    uint16_t bfType;
+    uint32_t bfSize;
+    uint16_t bfReserved1;
+    uint16_t bfReserved2;
+    uint32_t bfOffBits;
+};
+#pragma pack(pop)
+
+struct BITMAPINFOHEADER {
+    uint32_t biSize;
+    int32_t  biWidth;
+    int32_t  biHeight;
+    uint16_t biPlanes;
+    uint16_t biBitCount;
+    uint32_t biCompression;
+    uint32_t biSizeImage;
+    int32_t  biXPelsPerMeter;
+    int32_t  biYPelsPerMeter;
+    uint32_t biClrUsed;
+    uint32_t biClrImportant;
+};
+
+#ifndef BI_RGB
+#define BI_RGB 0
+#endif
+#endif
+
+// NV12 layout: full-size Y plane followed by interleaved UV at half resolution,
+// rounded up so odd frame sizes keep a chroma sample for the last row/column
+inline int NV12ChromaWidth(int width) { return (width + 1) / 2; }
+inline int NV12ChromaHeight(int height) { return (height + 1) / 2; }
+inline size_t NV12FrameSize(int width, int height) {
+    return static_cast<size_t>(width) * height +
+           static_cast<size_t>(NV12ChromaWidth(width)) * NV12ChromaHeight(height) * 2;
+}
 
 // Function to generate test pattern
 void FillNV12TestPattern(uint8_t* y_plane, uint8_t* uv_plane, int width, int height);
-
-// Save RGB data to BMP file
-bool SaveRGBToBMP(const char* filename, uint8_t* rgb_data, int width, int height);
\ No newline at end of file
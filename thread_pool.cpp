@@ -0,0 +1,71 @@
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int, int)>& fn) {
+    if (count <= 0) return;
+
+    int chunks = std::min(count, size());
+    if (chunks <= 1) {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int c = 0; c < chunks; c++) {
+            int begin = static_cast<int>(static_cast<long long>(count) * c / chunks);
+            int end = static_cast<int>(static_cast<long long>(count) * (c + 1) / chunks);
+            tasks.push_back([&fn, begin, end] {
+                TraceScope span("band", "pool");
+                fn(begin, end);
+            });
+        }
+        pendingTasks += chunks;
+    }
+    workAvailable.notify_all();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this] { return pendingTasks == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    TraceSetThreadName("pool worker");
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.back());
+            tasks.pop_back();
+        }
+
+        task();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pendingTasks == 0) {
+            workDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed-size worker pool for splitting frames into row bands
+class ThreadPool {
+public:
+    // threads <= 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    // Split [0, count) into one contiguous range per worker and run
+    // fn(begin, end) for each range. Blocks until all ranges are done.
+    void parallelFor(int count, const std::function<void(int, int)>& fn);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    std::vector<std::function<void()>> tasks;
+    int pendingTasks = 0;
+    bool stopping = false;
+};
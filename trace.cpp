@@ -0,0 +1,132 @@
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+bool traceEnabled = false;
+
+namespace {
+
+struct TraceSpan {
+    const char* name;
+    const char* category;
+    uint64_t startNs;
+    uint64_t durationNs;
+    int64_t frame;
+    int track;
+};
+
+std::vector<TraceSpan> spans;
+std::atomic<uint64_t> nextSpan(0);
+std::chrono::steady_clock::time_point traceEpoch;
+
+std::mutex threadMutex;
+std::vector<std::pair<int, std::string>> threadNames;
+std::atomic<int> nextThreadId(1);
+
+int currentThreadTrack() {
+    thread_local int track = nextThreadId++;
+    return track;
+}
+
+} // namespace
+
+void TraceStart(size_t capacity) {
+    spans.assign(std::max<size_t>(capacity, 1), TraceSpan());
+    nextSpan = 0;
+    traceEpoch = std::chrono::steady_clock::now();
+    traceEnabled = true;
+    TraceSetThreadName("main");
+}
+
+void TraceStop() {
+    traceEnabled = false;
+}
+
+uint64_t TraceNowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count());
+}
+
+void TraceSetThreadName(const char* name) {
+    if (!traceEnabled) return;
+    int track = currentThreadTrack();
+    std::lock_guard<std::mutex> lock(threadMutex);
+    for (auto& entry : threadNames) {
+        if (entry.first == track) {
+            entry.second = name;
+            return;
+        }
+    }
+    threadNames.emplace_back(track, name);
+}
+
+void TraceRecordSpan(const char* name, const char* category, uint64_t startNs, uint64_t endNs,
+                     int64_t frame, int track) {
+    if (!traceEnabled) return;
+    // One atomic increment claims a slot; writers never contend on a lock
+    uint64_t index = nextSpan.fetch_add(1, std::memory_order_relaxed);
+    TraceSpan& span = spans[index % spans.size()];
+    span.name = name;
+    span.category = category;
+    span.startNs = startNs;
+    span.durationNs = endNs > startNs ? endNs - startNs : 0;
+    span.frame = frame;
+    span.track = track < 0 ? currentThreadTrack() : track;
+}
+
+size_t TraceSpanCount() {
+    return static_cast<size_t>(nextSpan.load());
+}
+
+size_t TraceDroppedCount() {
+    size_t count = TraceSpanCount();
+    return count > spans.size() ? count - spans.size() : 0;
+}
+
+bool TraceWriteChromeJson(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open trace file " << path << std::endl;
+        return false;
+    }
+
+    // Oldest surviving span first
+    const size_t count = std::min(TraceSpanCount(), spans.size());
+    const size_t first = TraceSpanCount() - count;
+
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    file << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"shader_perf_test\"}}";
+    {
+        std::lock_guard<std::mutex> lock(threadMutex);
+        for (const auto& entry : threadNames) {
+            file << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << entry.first
+                 << ", \"args\": {\"name\": \"" << entry.second << "\"}}";
+        }
+    }
+    file << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << kTraceGpuTrack
+         << ", \"args\": {\"name\": \"GPU\"}}";
+    file << ",\n  {\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << kTraceGpuTrack
+         << ", \"args\": {\"sort_index\": -1}}";
+
+    // Timestamps are microseconds; keep the nanosecond digits
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    for (size_t i = 0; i < count; i++) {
+        const TraceSpan& span = spans[(first + i) % spans.size()];
+        file << ",\n  {\"name\": \"" << span.name << "\", \"cat\": \"" << span.category
+             << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << span.track
+             << ", \"ts\": " << span.startNs / 1000.0 << ", \"dur\": " << span.durationNs / 1000.0;
+        if (span.frame >= 0) {
+            file << ", \"args\": {\"frame\": " << span.frame << "}";
+        }
+        file << "}";
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
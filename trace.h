@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Per-stage tracing: timed spans kept in a preallocated ring buffer and exported
+// as Chrome trace JSON (chrome://tracing, ui.perfetto.dev). Each thread gets its
+// own track; GPU spans (GpuTraceTimer) go on a separate "GPU" track.
+//
+// Tracing is off until TraceStart. A disabled TraceScope costs one branch, and
+// an enabled one two clock reads and a ring-slot write. Span names and
+// categories must be string literals: only the pointers are stored.
+
+// Allocate room for capacity spans and start recording. When the ring is full
+// the oldest spans are overwritten (and counted as dropped).
+void TraceStart(size_t capacity = 1 << 18);
+void TraceStop();
+
+extern bool traceEnabled;
+inline bool TraceEnabled() { return traceEnabled; }
+
+// Nanoseconds on the trace clock (steady clock, zero at TraceStart)
+uint64_t TraceNowNs();
+
+// Label the calling thread's track
+void TraceSetThreadName(const char* name);
+
+// Track id of the GPU timeline
+const int kTraceGpuTrack = 1000;
+
+// Record a finished span; track < 0 means the calling thread. frame >= 0 is
+// shown as an argument so spans of one frame can be matched across tracks.
+void TraceRecordSpan(const char* name, const char* category, uint64_t startNs, uint64_t endNs,
+                     int64_t frame = -1, int track = -1);
+
+// Spans recorded so far (including overwritten ones) and how many were dropped
+size_t TraceSpanCount();
+size_t TraceDroppedCount();
+
+// Write every span in the ring as Chrome trace JSON ("X" complete events)
+bool TraceWriteChromeJson(const std::string& path);
+
+// Times the enclosing scope
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const char* category = "cpu", int64_t frame = -1)
+        : name(name), category(category), frame(frame), start(TraceEnabled() ? TraceNowNs() : 0) {}
+    ~TraceScope() {
+        if (TraceEnabled()) {
+            TraceRecordSpan(name, category, start, TraceNowNs(), frame);
+        }
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    const char* category;
+    int64_t frame;
+    uint64_t start;
+};
@@ -0,0 +1,235 @@
+#include "yuv_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kY4MMagic[] = "YUV4MPEG2 ";
+const char kY4MFrameTag[] = "FRAME";
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    if (suffix.size() > text.size()) return false;
+    for (size_t i = 0; i < suffix.size(); i++) {
+        char c = text[text.size() - suffix.size() + i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (c != suffix[i]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+YuvFileReader::~YuvFileReader() {
+    close();
+}
+
+bool YuvFileReader::open(const std::string& path, int width, int height) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open input " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    fileSize = static_cast<size_t>(size.QuadPart);
+    HANDLE mapping = fileSize ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    fileHandle = file;
+    mappingHandle = mapping;
+    if (!view) {
+        std::cerr << "Failed to map input " << path << std::endl;
+        close();
+        return false;
+    }
+    data = static_cast<const uint8_t*>(view);
+#else
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open input " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        std::cerr << "Input " << path << " is empty" << std::endl;
+        close();
+        return false;
+    }
+    fileSize = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map input " << path << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    data = static_cast<const uint8_t*>(mapped);
+    madvise(mapped, fileSize, MADV_SEQUENTIAL);
+#endif
+
+    if (fileSize >= sizeof(kY4MMagic) - 1 && memcmp(data, kY4MMagic, sizeof(kY4MMagic) - 1) == 0) {
+        if (!parseY4MHeader()) {
+            close();
+            return false;
+        }
+    } else {
+        frameFormat = endsWith(path, ".nv12") ? InputFormat::NV12 : InputFormat::I420;
+        frameWidth = width;
+        frameHeight = height;
+        frameBytes = InputFrameSize(frameFormat, width, height);
+        for (size_t offset = 0; offset + frameBytes <= fileSize; offset += frameBytes) {
+            frameOffsets.push_back(offset);
+        }
+        if (fileSize % frameBytes != 0) {
+            std::cout << "Warning: " << path << " is not a whole number of " << width << "x" << height
+                      << " " << InputFormatName(frameFormat) << " frames, ignoring the last "
+                      << fileSize % frameBytes << " bytes" << std::endl;
+        }
+    }
+
+    if (frameOffsets.empty()) {
+        std::cerr << "Input " << path << " holds no complete frame" << std::endl;
+        close();
+        return false;
+    }
+    advise(frameOffsets[0], frameBytes * prefetchFrames, true);
+    return true;
+}
+
+// YUV4MPEG2 W<w> H<h> [F.. I.. A.. C<colorspace> X..]\n, then per frame
+// FRAME [params]\n followed by the Y, U and V planes
+bool YuvFileReader::parseY4MHeader() {
+    const char* text = reinterpret_cast<const char*>(data);
+    const char* headerEnd = static_cast<const char*>(memchr(text, '\n', std::min<size_t>(fileSize, 1024)));
+    if (!headerEnd) {
+        std::cerr << "Malformed Y4M header" << std::endl;
+        return false;
+    }
+
+    std::string colorspace = "420jpeg";
+    const char* p = text + sizeof(kY4MMagic) - 1;
+    while (p < headerEnd) {
+        const char* tokenEnd = p;
+        while (tokenEnd < headerEnd && *tokenEnd != ' ') tokenEnd++;
+        std::string token(p, tokenEnd);
+        if (!token.empty()) {
+            switch (token[0]) {
+                case 'W': frameWidth = std::atoi(token.c_str() + 1); break;
+                case 'H': frameHeight = std::atoi(token.c_str() + 1); break;
+                case 'C': colorspace = token.substr(1); break;
+                default: break;  // frame rate, interlacing, aspect ratio, extensions
+            }
+        }
+        p = tokenEnd + 1;
+    }
+    if (frameWidth <= 0 || frameHeight <= 0) {
+        std::cerr << "Y4M header has no frame size" << std::endl;
+        return false;
+    }
+    if (colorspace != "420" && colorspace != "420jpeg" && colorspace != "420mpeg2" && colorspace != "420paldv") {
+        std::cerr << "Unsupported Y4M colorspace C" << colorspace << " (only 8-bit 4:2:0)" << std::endl;
+        return false;
+    }
+
+    frameFormat = InputFormat::I420;
+    frameBytes = InputFrameSize(frameFormat, frameWidth, frameHeight);
+
+    // Every frame header is checked: plain "FRAME\n" is matched directly, headers
+    // with parameters are walked to their newline
+    size_t offset = static_cast<size_t>(headerEnd - text) + 1;
+    const size_t tagLength = sizeof(kY4MFrameTag) - 1;
+    while (offset < fileSize) {
+        if (fileSize - offset <= tagLength || memcmp(data + offset, kY4MFrameTag, tagLength) != 0 ||
+            (data[offset + tagLength] != '\n' && data[offset + tagLength] != ' ')) {
+            std::cerr << "Malformed Y4M frame header at byte " << offset << std::endl;
+            break;
+        }
+        size_t samples = offset + tagLength + 1;
+        if (data[offset + tagLength] != '\n') {
+            const void* lineEnd = memchr(data + offset, '\n', std::min<size_t>(fileSize - offset, 256));
+            if (!lineEnd) {
+                std::cerr << "Malformed Y4M frame header at byte " << offset << std::endl;
+                break;
+            }
+            samples = static_cast<const uint8_t*>(lineEnd) - data + 1;
+        }
+        if (samples + frameBytes > fileSize) {
+            break;
+        }
+        frameOffsets.push_back(samples);
+        offset = samples + frameBytes;
+    }
+    return true;
+}
+
+void YuvFileReader::close() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    fileHandle = mappingHandle = nullptr;
+#else
+    if (data) munmap(const_cast<uint8_t*>(data), fileSize);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+#endif
+    data = nullptr;
+    fileSize = 0;
+    frameOffsets.clear();
+    position = 0;
+}
+
+const uint8_t* YuvFileReader::frame(size_t index) const {
+    return data + frameOffsets[index % frameOffsets.size()];
+}
+
+const uint8_t* YuvFileReader::nextFrame() {
+    size_t index = position;
+    position = (position + 1) % frameOffsets.size();
+
+    // Ask for the frame prefetchFrames ahead (earlier ones were requested on
+    // previous calls) and drop the frame before this one from the mapping, so a
+    // file larger than RAM streams through the page cache instead of pinning it
+    if (prefetchFrames > 0) {
+        advise(frameOffsets[(index + prefetchFrames) % frameOffsets.size()], frameBytes, true);
+    }
+    if (frameOffsets.size() > static_cast<size_t>(prefetchFrames) + 1) {
+        advise(frameOffsets[(index + frameOffsets.size() - 1) % frameOffsets.size()], frameBytes, false);
+    }
+    return data + frameOffsets[index];
+}
+
+void YuvFileReader::advise(size_t offset, size_t length, bool willNeed) const {
+#ifdef _WIN32
+    // The mapping is paged in on demand; FILE_FLAG_SEQUENTIAL_SCAN drives read-ahead
+    (void)offset;
+    (void)length;
+    (void)willNeed;
+#else
+    // madvise needs a page-aligned start. Prefetch widens the range to whole
+    // pages; release shrinks it, since dropping a partial page would also drop
+    // the neighbouring frame's samples on it.
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t start = offset & ~(pageSize - 1);
+    size_t end = std::min(offset + length, fileSize);
+    if (!willNeed) {
+        start = (offset + pageSize - 1) & ~(pageSize - 1);
+        if (end < fileSize) end &= ~(pageSize - 1);
+    }
+    if (end <= start) return;
+    madvise(const_cast<uint8_t*>(data) + start, end - start, willNeed ? MADV_WILLNEED : MADV_DONTNEED);
+#endif
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "pixel_formats.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Reads raw .nv12 / .yuv (I420) files and Y4M (YUV4MPEG2, 4:2:0 8-bit) files
+// through a read-only memory mapping. Frames are returned as pointers into the
+// mapping, so they can be copied straight into an upload buffer, and the file is
+// paged in on demand: files larger than RAM work, with the next few frames
+// prefetched and frames already consumed released from the mapping.
+class YuvFileReader {
+public:
+    YuvFileReader() = default;
+    ~YuvFileReader();
+    YuvFileReader(const YuvFileReader&) = delete;
+    YuvFileReader& operator=(const YuvFileReader&) = delete;
+
+    // Y4M files carry their own size; raw files use width x height and the layout
+    // implied by the extension (.nv12 = NV12, anything else = I420).
+    bool open(const std::string& path, int width, int height);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    InputFormat format() const { return frameFormat; }
+    int width() const { return frameWidth; }
+    int height() const { return frameHeight; }
+    size_t frameCount() const { return frameOffsets.size(); }
+    size_t frameSize() const { return frameBytes; }
+
+    // Frames to prefetch ahead of the read position (default 4)
+    void setPrefetchFrames(int frames) { prefetchFrames = frames > 0 ? frames : 0; }
+
+    // Frame at index, in format() layout. Pointer into the mapping.
+    const uint8_t* frame(size_t index) const;
+
+    // Next frame in file order, wrapping to the first frame at the end
+    const uint8_t* nextFrame();
+
+private:
+    bool parseY4MHeader();
+    void advise(size_t offset, size_t length, bool willNeed) const;
+
+    const uint8_t* data = nullptr;
+    size_t fileSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    InputFormat frameFormat = InputFormat::NV12;
+    int frameWidth = 0;
+    int frameHeight = 0;
+    size_t frameBytes = 0;
+    std::vector<size_t> frameOffsets;  // byte offset of each frame's samples
+    size_t position = 0;
+    int prefetchFrames = 4;
+};